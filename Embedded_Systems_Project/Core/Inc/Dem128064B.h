@@ -9,6 +9,8 @@
  * Author Husnain Khan
  */
 
+#include <stdint.h>
+
 /**
  * Enable pin position
  */
@@ -56,11 +58,154 @@
  */
 #define TOTAL_COLS 128
 
+/**
+ * LCD bus timing,
+ * 0 waits a fixed 5 micro seconds (TIM10) after every enable edge,
+ * 1 reads the status register of the lcd after every enable pulse
+ * and continues as soon as the busy flag is cleared.
+ * Measured with the host simulator (make run / make run POLLING=1),
+ * bus time per frame: game 436 / 43 us (max 1130 / 113 us),
+ * welcome 2655 / 332 us, setUp 5370 / 1074 us. The enable strobes double
+ * with polling (one status read per write); the simulated controller is
+ * never busy, so polling shows its lower bound, a real KS0108 is busy
+ * for a few micro seconds after a write
+ */
+#ifndef LCD_BUSY_POLLING
+#define LCD_BUSY_POLLING 0
+#endif
+
+/**
+ * Busy flag is bit 7 of the status register (PC7)
+ */
+#define LCD_BUSY_BIT 7
+
+/**
+ * Time after which busy polling gives up and continues
+ * like the fixed delay, in micro seconds (TIM10 counts)
+ */
+#define LCD_BUSY_TIMEOUT_US 5
+
+/**
+ * Loops of getShortDelay, about 0.5 micro seconds at 84 MHz
+ * (enable pulse width and data delay time of the lcd)
+ */
+#define LCD_SHORT_DELAY_LOOPS 8
+
+/**
+ * Background refresh,
+ * 1 sends the changed bytes with DMA2 stream 5 paced by timer 1,
+ * every word of a precomputed GPIOC->BSRR sequence is one bus edge
+ */
+#ifndef LCD_DMA_REFRESH
+#define LCD_DMA_REFRESH 0
+#endif
+
+/**
+ * Time between two words of the background refresh in micro seconds,
+ * same as getDelay
+ */
+#define LCD_DMA_STEP_US 5
+
+/**
+ * Words of one background refresh segment, 3 words per bus write,
+ * display on, page, column and 64 data bytes
+ */
+#define LCD_DMA_SEGMENT_WORDS ((3 + MAX_COLS_LCD) * 3)
+
+/**
+ * Time sliced refresh,
+ * 1 sends the changed bytes in slices of at most LCD_SLICE_WRITES bus writes,
+ * refresh_Screen_Slice is called every timer tick and resumes where the last
+ * slice stopped, so the time spent in the SysTick handler stays bounded
+ */
+#ifndef LCD_SLICED_REFRESH
+#define LCD_SLICED_REFRESH 0
+#endif
+
+/**
+ * Bus writes (enable strobes) of one refresh slice, about 10 micro seconds each
+ * with getDelay. A full screen takes about 1100 writes with addressing, so 32 writes
+ * per tick finish any frame in less then 40 ticks, within REFRESH_RATE
+ */
+#ifndef LCD_SLICE_WRITES
+#define LCD_SLICE_WRITES 32
+#endif
+
+/**
+ * Grayscale with temporal dithering,
+ * 1 adds two bit planes (LAYER_GRAY_LOW and LAYER_GRAY_HIGH) which give
+ * every pixel a gray level from 0 to 3, level = low + 2 * high.
+ * gray_Next_Phase steps through GRAY_PHASES frame phases, a pixel of
+ * level n is on in n of them, so it is shown dimmed when the phases are
+ * sent fast enough. Only columns with pixels of level 1 or 2 change
+ * between phases: a band of one page over the full width costs
+ * 134 bus writes (128 data and 6 addressing) in 2 of the 3 phase steps,
+ * about 1.3 ms of bus time. The host simulator measures the budget
+ * of the gray game scene against the phase rate of app.h.
+ * The game needs LCD_SLICED_REFRESH or LCD_DMA_REFRESH with it, a phase
+ * step of up to 295 writes would block the SysTick handler for about 3 ms
+ */
+#ifndef LCD_GRAYSCALE
+#define LCD_GRAYSCALE 0
+#endif
+
+/**
+ * frame phases of the gray levels
+ */
+#define GRAY_PHASES 3
+
+/**
+ * Bus writes needed to set the address before a burst: display on, page, column
+ */
+#define LCD_ADDRESS_WRITES 3
+
+/**
+ * Chips selected by a bus write, left half (CS1), right half (CS2) or both
+ */
+#define LCD_CS_LEFT 1
+#define LCD_CS_RIGHT 2
+#define LCD_CS_BOTH 3
+
+/**
+ * Pins of PORTC driven by the lcd bus (data, DI, RW, CS1, CS2 and E)
+ */
+#define LCD_BUS_MASK (0xFF | (1 << DI_pos) | (1 << RW_pos) | (1 << CS1_pos) \
+		| (1 << CS2_pos) | (1 << E_pos))
+
+/**
+ * Unchanged bytes between two changed bytes of a page which are
+ * sent again instead of starting a new burst,
+ * a new burst costs 3 enable strobes for the address
+ */
+#define MAX_BURST_GAP 3
+
 /**
  * one page has 8 pixels
  */
 #define PAGE_LEN 8
 
+/**
+ * Total pages of the lcd, every page is 8 rows high
+ * and has one byte per column (bit 0 is the top row of the page)
+ */
+#define TOTAL_PAGES (TOTAL_ROWS / PAGE_LEN)
+
+/**
+ * first row of the welcome and game over messages
+ */
+#define BANNER_START_ROW 10
+
+/**
+ * first row and column of the score digits written by writeNumber
+ */
+#define SCORE_ROW 30
+#define SCORE_DIGIT_COL 10
+
+/**
+ * most digits drawNumber draws, enough for any 32 bit number
+ */
+#define MAX_NUMBER_DIGITS 10
+
 /**
  * length of the moving line
  */
@@ -85,6 +230,61 @@ struct previousPos {
 	int prev_Col;
 } prevPos;
 
+/**
+ * Layers the drawing functions can draw into,
+ * the dynamic layer for moving objects and the static layer for
+ * banners and the score, the lcd shows both layers OR-ed together
+ */
+#define LAYER_DYNAMIC 0
+#define LAYER_STATIC 1
+
+/**
+ * Bit planes of the gray levels (only with LCD_GRAYSCALE),
+ * drawn like the other layers or with gray_Fill_Rect and gray_Blit
+ */
+#define LAYER_GRAY_LOW 2
+#define LAYER_GRAY_HIGH 3
+
+/**
+ * most objects of the retained scene
+ */
+#define MAX_SCENE_OBJECTS 8
+
+/**
+ * Raster operations of blit,
+ * copy the sprite, set (or), toggle (xor) or clear (and not) its pixels
+ */
+#define ROP_COPY 0
+#define ROP_OR 1
+#define ROP_XOR 2
+#define ROP_AND_NOT 3
+
+/**
+ * Bitmap stored in flash, same layout as the display array:
+ * one byte per column and page, bit 0 is the top row of the page,
+ * data[page * width + column]
+ */
+struct bitmap {
+	uint8_t width;
+	uint8_t height;
+	const uint8_t *data;
+};
+
+/**
+ * Bitmap font stored in flash, glyphs for the characters first to last.
+ * Every glyph is a width x height bitmap in the layout of struct bitmap,
+ * the glyphs follow each other in data. advance is the column step
+ * from one glyph to the next
+ */
+struct font {
+	uint8_t width;
+	uint8_t height;
+	uint8_t advance;
+	char first;
+	char last;
+	const uint8_t *data;
+};
+
 /**
  * TURN ON SCREEN PORTC Value 
  * Value to be written on portc to turn on the screen
@@ -103,6 +303,13 @@ struct previousPos {
  */
 #define COL_SEL_MASK 0x40
 
+/**
+ * 11,A5,A4,A3,A2,A1,A0
+ * display start line, the ram row shown at the top of the screen
+ * is ored with this mask
+ */
+#define START_LINE_MASK 0xC0
+
 /**
  * setUp for the LCD, initilization of the display,
  * setting the prev position of the to 0, clearing the screen
@@ -131,6 +338,11 @@ extern void reset_Enable(void);
  */
 extern void turn_On_Screen(void);
 
+/**
+ * put a byte on the data pins
+ */
+extern void send_Data(uint8_t data);
+
 /**
  * set Control Buss to Write
  */
@@ -161,6 +373,21 @@ extern void set_Both_Side_Screen(void);
  */
 extern void toggle_Enable_Lcd(void);
 
+/**
+ * delay of 5 micro seconds (TIM10) after an enable edge
+ */
+extern void getDelay(void);
+
+/**
+ * short delay, enable pulse width and data delay time of the lcd
+ */
+extern void getShortDelay(void);
+
+/**
+ * wait until the selected controllers clear the busy flag
+ */
+extern void wait_Lcd_Ready(void);
+
 /**
  * Write welcome on Display array
  */
@@ -173,9 +400,282 @@ extern void writeWelcomeToArray(void);
 extern void writeGameOver(void);
 
 /**
- * write the given number, to shift is used to shift the col
+ * write the given digit, to shift is used to shift the col
  */
 extern void writeNumber(int number, int toShift);
 
+/**
+ * draw a string with its top left corner at column x and row y,
+ * return the column after the last glyph
+ */
+extern int drawText(const char *text, int x, int y, const struct font *font);
+
+/**
+ * draw a number, at least minDigits digits with leading zeros,
+ * return the column after the last digit
+ */
+extern int drawNumber(uint32_t number, int minDigits, int x, int y,
+		const struct font *font);
+
+/**
+ * width in pixels of a number drawn with drawNumber
+ */
+extern int get_Number_Width(uint32_t number, int minDigits,
+		const struct font *font);
+
+/**
+ * score digits 11 x 21 pixels and small text font 5 x 7 pixels
+ */
+extern const struct font scoreFont;
+extern const struct font smallFont;
+
+/**
+ * clear the lcd, both halves at once
+ */
+extern void clear_Screen(void);
+
+/**
+ * fill the whole lcd with pattern, both halves at once,
+ * the next refresh sends the display array again where it differs
+ */
+extern void fill_Screen(uint8_t pattern);
+
+/**
+ * set (setOrClear 1) or clear the 3 x 3 ball around row and col
+ */
+extern void set_Ball_To_Position(int row, int col, int setOrClear);
+
+/**
+ * draw (setClear 1) or clear a vertical line
+ */
+extern void draw_Vert_Line(uint8_t startRow, int startCol, uint8_t verticalLen,
+		uint8_t setClear);
+
+/**
+ * draw a horizontal line
+ */
+extern void draw_Horiz_Line(uint8_t startRow, uint8_t startCol,
+		uint8_t horizonLen);
+
+/**
+ * set one pixel of the display array
+ */
+extern void writeToDisplayArr(int row, int col);
+
+/**
+ * clear one pixel of the display array
+ */
+extern void clearDisplayArr(int row, int col);
+
+/**
+ * clear the selected layer of the display array, all pixels set to 0
+ */
+extern void init_DisplayArray(void);
+
+/**
+ * mark all pages of the display array as clean
+ */
+extern void clear_Dirty(void);
+
+/**
+ * swap back and front buffer, the drawn frame is handed over to the refresh,
+ * return 0 if a background refresh is running and nothing was swapped
+ */
+extern int present(void);
+
+/**
+ * send the changed bytes of the presented frame to the lcd
+ */
+extern void refreshScreen(void);
+
+/**
+ * number of bytes sent to the lcd by the last refreshScreen,
+ * used to check how much bus traffic one frame costs
+ */
+extern uint32_t get_Last_Refresh_Writes(void);
+
+/**
+ * number of bytes sent to the lcd since start up
+ */
+extern uint32_t get_Total_Lcd_Writes(void);
+
+/**
+ * number of enable strobes since start up
+ */
+extern uint32_t get_Total_Lcd_Strobes(void);
+
+/**
+ * write one byte at the given page and column
+ */
+extern void write_On_Screen(uint8_t page, uint8_t col_Address, uint8_t data);
+
+/**
+ * set page and column address, following data writes start here
+ */
+extern void set_Lcd_Address(uint8_t page, uint8_t col_Address);
+
+/**
+ * send len bytes to the address set with set_Lcd_Address,
+ * must stay inside one half of the screen
+ */
+extern void stream_Data(const uint8_t *data, int len);
+
+/**
+ * write len bytes starting at page and column using the
+ * column auto increment of the lcd
+ */
+extern void write_Burst_On_Screen(uint8_t page, uint8_t col_Address,
+		const uint8_t *data, int len);
+
+/**
+ * duration of the last refreshScreen in micro seconds
+ */
+extern uint32_t get_Last_Refresh_Time_Us(void);
+
+/**
+ * byte of the presented frame at the given page and column,
+ * both layers OR-ed together
+ */
+extern uint8_t get_Output_Byte(int page, int col);
+
+/**
+ * select the layer the drawing functions draw into,
+ * LAYER_DYNAMIC (default), LAYER_STATIC or a gray plane
+ */
+extern void select_Layer(int layer);
+
+/**
+ * mark every byte as changed, the next refresh sends the whole screen
+ */
+extern void invalidate_Screen(void);
+
+/**
+ * scroll the screen, from the next presented frame on screen row r shows
+ * row (r + line) % TOTAL_ROWS of the display array, the start line of both
+ * chips is set after the frame is sent, no data is sent again
+ */
+extern void set_Scroll(int line);
+
+/**
+ * scroll of the frame being drawn
+ */
+extern int get_Scroll(void);
+
+/**
+ * scroll of the presented frame, set on the lcd by the next refresh
+ */
+extern int get_Presented_Scroll(void);
 
+/**
+ * row of the display array shown at a row of the screen
+ * with the scroll of the frame being drawn
+ */
+extern int scroll_Row(int row);
+
+/**
+ * scroll by lines, positive lines move the content up, the rows which
+ * become visible are cleared in the selected layer,
+ * return the display array row of the top most of them
+ */
+extern int scroll_Lines(int lines);
+
+/**
+ * byte the screen shows at page and column after the next refresh,
+ * the presented frame with its scroll applied
+ */
+extern uint8_t get_Screen_Byte(int page, int col);
+
+/**
+ * function called when a background refresh is finished
+ */
+typedef void (*lcd_refresh_cb_t)(void);
+
+/**
+ * start a background refresh, return 0 if one is still running
+ */
+extern int refresh_Screen_Dma(void);
+
+/**
+ * 1 while a background refresh is running
+ */
+extern int refresh_In_Progress(void);
+
+/**
+ * set the function called when a background refresh is finished
+ */
+extern void set_Refresh_Done_Callback(lcd_refresh_cb_t callback);
+
+/**
+ * fill a rectangle of the display array, clipped at the screen edges,
+ * ROP_OR sets, ROP_AND_NOT clears and ROP_XOR inverts the pixels
+ */
+extern void fill_Rect(int x, int y, int width, int height, int rop);
+
+/**
+ * invert all pixels of the display array
+ */
+extern void invert_DisplayArr(void);
+
+/**
+ * send the next slice of the presented frame, at most LCD_SLICE_WRITES bus writes,
+ * return 1 when the lcd shows the whole frame
+ */
+extern int refresh_Screen_Slice(void);
+
+/**
+ * longest refresh slice since start up in micro seconds
+ */
+extern uint32_t get_Max_Slice_Time_Us(void);
+
+/**
+ * draw a sprite to the display array, top left corner at column x and row y,
+ * clipped at the screen edges, rop is one of ROP_COPY, ROP_OR, ROP_XOR, ROP_AND_NOT
+ */
+extern void blit(const struct bitmap *sprite, int x, int y, int rop);
+
+/**
+ * the ball, 3 x 3 pixels
+ */
+extern const struct bitmap ballSprite;
+
+/**
+ * add an object to the retained scene, top left corner of the sprite
+ * at column x and row y, return its id or -1 if the scene is full
+ */
+extern int scene_Add(const struct bitmap *sprite, int x, int y);
+
+/**
+ * move an object of the scene
+ */
+extern void scene_Move(int id, int x, int y);
+
+/**
+ * show (visible 1) or hide an object of the scene
+ */
+extern void scene_Show(int id, int visible);
+
+/**
+ * draw the changes of the scene into the dynamic layer,
+ * called once per frame before present
+ */
+extern void scene_Update(void);
+
+#if LCD_GRAYSCALE
+/**
+ * fill a rectangle of the gray planes with a gray level from 0 to 3
+ */
+extern void gray_Fill_Rect(int x, int y, int width, int height, int level);
+
+/**
+ * draw the set pixels of a sprite into the gray planes with a gray level,
+ * level 0 removes them
+ */
+extern void gray_Blit(const struct bitmap *sprite, int x, int y, int level);
+
+/**
+ * step to the next frame phase, the columns with dimmed pixels are
+ * handed to the refresh, return 0 while a background refresh is running
+ */
+extern int gray_Next_Phase(void);
+#endif
 
@@ -14,115 +14,79 @@
 #ifndef INC_APP_H_
 #define INC_APP_H_
 
-/**
- * Sensor refresh rate
- */
-#define SENSOR_REFRESH_RATE	50
-
-/**
- * Ball movement rate
- */
-#define BALL_MOVEMENT_RATE 20
-
-/**
- * Screen refresh
- */
-#define REFRESH_RATE 50
-
-/**
- * Upper line movement rate
- */
-#define MOVE_LINE_UPPER_RATE 30
-
-/**
- * Lower line movement rate
- */
-#define MOVE_LINE_LOWER_RATE 40
-
-/**
- * Delay for the welcome message
- */
-#define WELCOME_MESSAGE_DELAY 2000
-
-/**
- * Delay for the game over
- */
-#define GAME_OVER_DELAY 2000
-
-/**
- * Starting row of upper line
- */
-#define START_OF_UPPER_LINE 0
+#include "app_config.h"
 
 /**
- * Length of upper line
+ * Used to keep track if the game is Ended or not
+ * 0 if game is running, 1 if game is ended
  */
-#define LENGTH_UPPER_LINE 30
+extern volatile int gameEnd = 0;
 
 /**
- * Starting of lower line
+ * initilization
  */
-#define START_OF_LOWER_LINE 30
+extern void app_init(void);
 
 /**
- * Length of lower line
+ * loop function, called inside the main loop,
+ * game End is to be checked here if the game
+ * is ended then a message is to be shown to the user
+ * for a period of time
  */
-#define LENGTH_OF_LOWER_LINE 33
+extern void app_loop(void);
 
 /**
- * starting column of moving lines
+ * used to get the mpu data,
+ * the new data is calculated and is to be set
+ * in the tilt angles inside the mpu module
  */
-#define START_LINE_COL_VALUE 127
+extern int getMpuData(void);
 
 /**
- * Column shift value for unit
+ * refresh the screen,
+ * the pixels stored locally in a 2d array
+ * are to be reflected to the screen
  */
-#define UNIT_COL_SHIFT_VAL 60
+extern void refresh(void);
 
 /**
- * Column shift value for Ten
+ * refresh called by the timer, skipped while the main loop draws
  */
-#define TEN_COL_SHIFT_VAL 30
+extern void refreshTick(void);
 
 /**
- * MAX points user can score in the game,
- * if points are greater then max score then points
- * will not be shown on the display
+ * present the frame and send all of it to the screen at once
  */
-#define MAX_SCORE 100
+extern void refreshNow(void);
 
 /**
- * Used to keep track if the game is Ended or not
- * 0 if game is running, 1 if game is ended
+ * send the next slice of the presented frame,
+ * only used with LCD_SLICED_REFRESH
  */
-extern volatile int gameEnd = 0;
+extern void refreshSlice(void);
 
 /**
- * initilization
+ * print the longest refresh slice on the uart,
+ * only used with LCD_SLICED_REFRESH
  */
-extern void app_init(void);
+extern void reportSliceTime(void);
 
 /**
- * loop function, called inside the main loop,
- * game End is to be checked here if the game
- * is ended then a message is to be shown to the user
- * for a period of time
+ * step to the next gray phase and send the dimmed pixels,
+ * only used with LCD_GRAYSCALE
  */
-extern void app_loop(void);
+extern void grayPhase(void);
 
 /**
- * used to get the mpu data,
- * the new data is calculated and is to be set
- * in the tilt angles inside the mpu module
+ * draw the fading trail behind the ball into the gray planes,
+ * only used with LCD_GRAYSCALE
  */
-extern int getMpuData(void);
+extern void drawTrail(void);
 
 /**
- * refresh the screen,
- * the pixels stored locally in a 2d array
- * are to be reflected to the screen
+ * print the measurements of the display entry points on uart 2
  */
-extern void refresh(void);
+extern void dumpPerf(void);
 
 /**
  * Used to move the line,
@@ -0,0 +1,119 @@
+/**
+ * Timing and layout of the game, the rates are in SysTick ticks (ms).
+ * Used by the app module and by the host run of the LCD driver
+ * (Host/Src/sim_main.c), so the host checks of the refresh and the
+ * gray phases measure the configuration of the firmware.
+ *
+ * Author Husnain Khan
+ */
+
+#ifndef INC_APP_CONFIG_H_
+#define INC_APP_CONFIG_H_
+
+/**
+ * Sensor refresh rate
+ */
+#define SENSOR_REFRESH_RATE	50
+
+/**
+ * Ball movement rate
+ */
+#define BALL_MOVEMENT_RATE 20
+
+/**
+ * Screen refresh
+ */
+#define REFRESH_RATE 50
+
+/**
+ * Refresh slice rate, every tick
+ * (only used with LCD_SLICED_REFRESH)
+ */
+#define REFRESH_SLICE_RATE 1
+
+/**
+ * Gray phase rate, the dimmed pixels are on for 1 or 2 of 3 phases,
+ * one gray cycle takes 30 ticks (only used with LCD_GRAYSCALE)
+ */
+#define GRAY_PHASE_RATE 10
+
+/**
+ * Upper line movement rate
+ */
+#define MOVE_LINE_UPPER_RATE 30
+
+/**
+ * Lower line movement rate
+ */
+#define MOVE_LINE_LOWER_RATE 40
+
+/**
+ * Delay for the welcome message
+ */
+#define WELCOME_MESSAGE_DELAY 2000
+
+/**
+ * Delay for the game over
+ */
+#define GAME_OVER_DELAY 2000
+
+/**
+ * Starting row of upper line
+ */
+#define START_OF_UPPER_LINE 0
+
+/**
+ * Length of upper line
+ */
+#define LENGTH_UPPER_LINE 30
+
+/**
+ * Starting of lower line
+ */
+#define START_OF_LOWER_LINE 30
+
+/**
+ * Length of lower line
+ */
+#define LENGTH_OF_LOWER_LINE 33
+
+/**
+ * starting column of moving lines
+ */
+#define START_LINE_COL_VALUE 127
+
+/**
+ * Column the score is centred on
+ */
+#define SCORE_CENTER_COL 60
+
+/**
+ * Score is shown with at least two digits
+ */
+#define SCORE_MIN_DIGITS 2
+
+/**
+ * Dimmed band between the lanes of the upper and the lower line,
+ * gray level 1 (only used with LCD_GRAYSCALE)
+ */
+#define GRAY_LANE_ROW 29
+#define GRAY_LANE_HEIGHT 2
+#define GRAY_LANE_LEVEL 1
+
+/**
+ * Positions of the ball in the last frames drawn as a fading trail,
+ * the newest one with gray level GRAY_TRAIL_LEN (only used with LCD_GRAYSCALE)
+ */
+#define GRAY_TRAIL_LEN 2
+
+/**
+ * Byte received on uart 2 which requests a dump of the display measurements
+ */
+#define PERF_DUMP_CMD 'p'
+
+/**
+ * Byte received on uart 2 which turns the uart mirror of the lcd on and off
+ */
+#define MIRROR_TOGGLE_CMD 'm'
+
+#endif /* INC_APP_CONFIG_H_ */
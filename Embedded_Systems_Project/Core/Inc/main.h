@@ -71,6 +71,12 @@ void Error_Handler(void);
 #define SWO_Pin GPIO_PIN_3
 #define SWO_GPIO_Port GPIOB
 /* USER CODE BEGIN Private defines */
+#define MPU_INT_Pin GPIO_PIN_10
+#define MPU_INT_GPIO_Port GPIOA
+#define MPU_INT_EXTI_IRQn EXTI15_10_IRQn
+#define MPU_SCL_Pin GPIO_PIN_8
+#define MPU_SDA_Pin GPIO_PIN_9
+#define MPU_I2C_GPIO_Port GPIOB
 
 /* USER CODE END Private defines */
 
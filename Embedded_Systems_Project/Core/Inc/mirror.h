@@ -0,0 +1,108 @@
+/**
+ * Mirror module sends the frames shown on the lcd over uart 2,
+ * so the screen can be watched on a pc (Host/Src/mirror_view.c).
+ * Only the bytes which changed since the last sent frame are sent:
+ * the page major frame is XORed with the last sent one and the result is
+ * run length encoded, unchanged bytes cost one byte per MIRROR_RUN_MAX.
+ * At 115200 baud about 576 bytes can be sent every REFRESH_RATE (50 ms),
+ * a moving ball and two lines need less than 40 bytes per frame.
+ * The frame is sent as the display array without the scroll, the scroll
+ * is sent in the header and applied by the viewer, so a scroll step only
+ * costs the band of rows which became visible.
+ * A frame is skipped while the last packet is still sent, its changes
+ * are sent with the next frame.
+ *
+ * Packet:
+ *   MIRROR_SYNC1 MIRROR_SYNC2 seq flags scroll lenLow lenHigh payload checksum
+ * seq counts the sent frames, flags has MIRROR_FLAG_KEY when the payload
+ * is coded against an empty frame, screen row r shows row
+ * (r + scroll) % TOTAL_ROWS of the frame, checksum is the XOR of seq, flags,
+ * scroll, the length bytes and the payload.
+ * Payload, a sequence of runs starting at page 0 column 0:
+ *   control < 0x80  : control + 1 unchanged bytes
+ *   control >= 0x80 : (control & 0x7F) + 1 XOR bytes follow
+ * bytes after the last run are unchanged.
+ *
+ * Author Husnain Khan
+ */
+
+#ifndef INC_MIRROR_H_
+#define INC_MIRROR_H_
+
+#include <stdint.h>
+
+/**
+ * first two bytes of every packet
+ */
+#define MIRROR_SYNC1 0xA5
+#define MIRROR_SYNC2 0x5A
+
+/**
+ * bytes of a packet around the payload, sync, seq, flags, scroll, length,
+ * checksum
+ */
+#define MIRROR_HEADER_LEN 7
+#define MIRROR_TRAILER_LEN 1
+
+/**
+ * the payload is coded against an empty frame,
+ * the viewer can start with this packet
+ */
+#define MIRROR_FLAG_KEY 0x01
+
+/**
+ * longest run of one control byte
+ */
+#define MIRROR_RUN_MAX 128
+
+/**
+ * Unchanged runs shorter than this are sent as XOR bytes (zero),
+ * so the payload never grows beyond the frame size and a control byte
+ * per MIRROR_RUN_MAX bytes
+ */
+#define MIRROR_MIN_SKIP 2
+
+/**
+ * size of the frame and the largest packet
+ */
+#define MIRROR_FRAME_LEN (8 * 128)
+#define MIRROR_PAYLOAD_MAX (MIRROR_FRAME_LEN + MIRROR_FRAME_LEN / MIRROR_RUN_MAX + 1)
+#define MIRROR_PACKET_MAX (MIRROR_HEADER_LEN + MIRROR_PAYLOAD_MAX + MIRROR_TRAILER_LEN)
+
+/**
+ * every MIRROR_KEY_INTERVAL sent frames a key frame is sent,
+ * so a viewer which missed a packet can continue
+ */
+#define MIRROR_KEY_INTERVAL 64
+
+/**
+ * turn the mirror on or off, turning it on sends a key frame next
+ */
+extern void mirror_Enable(int enable);
+
+/**
+ * 1 when the mirror is on
+ */
+extern int mirror_Is_Enabled(void);
+
+/**
+ * send the changes of the frame shown on the lcd (front buffer and static
+ * layer) since the last sent frame with its scroll, call after present,
+ * does nothing when the mirror is off or the last packet is still sent
+ */
+extern void mirror_Frame(void);
+
+/**
+ * code the delta of frame to previous into packet, previous is updated
+ * to frame, return the length of the packet
+ */
+extern int mirror_Encode(const uint8_t *frame, uint8_t *previous, uint8_t seq,
+		uint8_t flags, uint8_t scroll, uint8_t *packet);
+
+/**
+ * frames sent and skipped since mirror_Enable
+ */
+extern uint32_t mirror_Get_Sent_Frames(void);
+extern uint32_t mirror_Get_Skipped_Frames(void);
+
+#endif /* INC_MIRROR_H_ */
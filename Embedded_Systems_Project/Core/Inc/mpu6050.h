@@ -4,12 +4,25 @@
  * sensor is in the form of acceleration in three axis x, y and z
  * this acceleration is then converted to
  * tilt angle and is stored in a structure of angles having two angles thetaX and thetaY.
+ * All sensor registers (accelerometer, temperature and gyro) are read
+ * in one burst and decoded into a sample.
+ * The burst is read blocking or in the background (MPU_ACQ_MODE),
+ * a background read is started by startRead and its sample is
+ * published by the completion callback.
+ * With MPU_DATA_READY_INT the sensor starts every read itself, its data
+ * ready interrupt line (INT) is wired to MPU_INT_Pin and every rising edge
+ * starts the background read.
+ * With MPU_FIFO_MODE the sensor samples at 1 kHz into its FIFO and
+ * startRead drains all complete frames in one burst, the samples are
+ * queued with their time stamp and taken as a batch by takeBatch.
  *
  * Created on: Nov 26, 2021
  * Author: Husnain
  *
  */
 
+#include <stdint.h>
+
 /**
  * Who Am I register
  */
@@ -25,6 +38,61 @@
  */
 #define ACCEL_CONFIG_REG 0x1C
 
+/**
+ * Sample rate divider and configuration (digital low pass filter) Registers,
+ * sample rate = 1 kHz / (1 + divider) when the filter is on
+ */
+#define SMPLRT_DIV_REG 0x19
+#define CONFIG_REG 0x1A
+
+/**
+ * Interrupt pin configuration, interrupt enable and status Registers
+ */
+#define INT_PIN_CFG_REG 0x37
+#define INT_ENABLE_REG 0x38
+#define INT_STATUS_REG 0x3A
+
+/**
+ * FIFO enable, user control, FIFO count (high byte first)
+ * and FIFO read/write Registers
+ */
+#define FIFO_EN_REG 0x23
+#define USER_CTRL_REG 0x6A
+#define FIFO_COUNT_REG 0x72
+#define FIFO_R_W_REG 0x74
+
+/**
+ * FIFO_EN bits of the sensors written into the FIFO,
+ * the FIFO holds the enabled sensors in register order
+ */
+#define FIFO_EN_ACCEL 0x08
+#define FIFO_EN_GYRO 0x70
+
+/**
+ * USER_CTRL bits, FIFO_RESET clears the FIFO and clears itself
+ */
+#define USER_CTRL_FIFO_EN 0x40
+#define USER_CTRL_FIFO_RESET 0x04
+
+/**
+ * DATA_RDY_EN bit of INT_ENABLE, INT goes high when all sensor data
+ * registers have a new sample
+ */
+#define INT_DATA_RDY_EN 0x01
+
+/**
+ * INT_PIN_CFG: active high, push pull, a 50 us pulse per interrupt,
+ * a latched level would stay high when an edge is missed
+ */
+#define INT_PIN_CFG_PULSE 0x00
+
+/**
+ * low pass filter 44 Hz (accelerometer), gyro output rate 1 kHz,
+ * divided to 50 Hz, one sample every SENSOR_REFRESH_RATE ms
+ */
+#define MPU_DLPF_CFG 3
+#define MPU_SAMPLE_RATE_DIV 19
+
 /**
  * 7 bits address value in datasheet
  * shifted to the left
@@ -32,11 +100,187 @@
 #define MPU_ADDRESS (0xD0)
 
 /**
- * Address to read accelerometer data
+ * Address to read accelerometer data,
+ * first of the sensor data registers
  */
 #define ACCEL_XOUT 0x3B
-#define ACCEL_YOUT 0x3D
-#define ACCEL_ZOUT 0x3F
+
+/**
+ * Sensor data registers 0x3B to 0x48 read in one burst,
+ * accelerometer x, y, z, temperature and gyro x, y, z,
+ * every value 16 bit, high byte first
+ */
+#define SENSOR_DATA_LEN 14
+
+/**
+ * I2C bus speed of the sensor, standard mode 100 kHz or fast mode 400 kHz,
+ * applied by mpu6050_init. Fast mode uses a low/high ratio of 2, with the
+ * 42 MHz APB1 clock this gives exactly 400 kHz (16/9 would round to
+ * 420 kHz). Slow edges of long wires or weak pull ups show as a longer
+ * or failing data burst in the timing report (perf)
+ */
+#define MPU_I2C_STANDARD 100000
+#define MPU_I2C_FAST 400000
+
+#ifndef MPU_I2C_SPEED
+#define MPU_I2C_SPEED MPU_I2C_STANDARD
+#endif
+
+#define MPU_I2C_DUTY_CYCLE I2C_DUTYCYCLE_2
+
+/**
+ * Acquisition of the sensor data,
+ * MPU_ACQ_BLOCKING reads in the caller (readData),
+ * MPU_ACQ_IT starts the read (startRead) which runs in the background,
+ * the whole transaction is run from the I2C1 event interrupt and the
+ * completion callback publishes the sample.
+ * There is no DMA read: the HAL sends the device and register address of a
+ * DMA read by polling with HAL_GetTick timeouts, which can not expire in
+ * the SysTick or EXTI handler which starts the read
+ */
+#define MPU_ACQ_BLOCKING 0
+#define MPU_ACQ_IT 1
+
+#ifndef MPU_ACQ_MODE
+#define MPU_ACQ_MODE MPU_ACQ_IT
+#endif
+
+#if MPU_ACQ_MODE != MPU_ACQ_BLOCKING && MPU_ACQ_MODE != MPU_ACQ_IT
+#error "MPU_ACQ_MODE must be MPU_ACQ_BLOCKING or MPU_ACQ_IT"
+#endif
+
+/**
+ * 1: the samples are collected in the FIFO of the sensor and drained
+ * every MPU_FIFO_SERVICE_RATE ms, needs a background acquisition
+ * and no data ready interrupt
+ */
+#ifndef MPU_FIFO_MODE
+#define MPU_FIFO_MODE 0
+#endif
+
+/**
+ * 1: the data ready interrupt of the sensor starts every read,
+ * 0: getMpuData starts it every SENSOR_REFRESH_RATE ms,
+ * needs a background acquisition
+ */
+#ifndef MPU_DATA_READY_INT
+#if MPU_ACQ_MODE != MPU_ACQ_BLOCKING && !MPU_FIFO_MODE
+#define MPU_DATA_READY_INT 1
+#else
+#define MPU_DATA_READY_INT 0
+#endif
+#endif
+
+#if MPU_DATA_READY_INT && MPU_ACQ_MODE == MPU_ACQ_BLOCKING
+#error "MPU_DATA_READY_INT needs MPU_ACQ_IT"
+#endif
+
+#if MPU_FIFO_MODE && (MPU_ACQ_MODE == MPU_ACQ_BLOCKING || MPU_DATA_READY_INT)
+#error "MPU_FIFO_MODE needs a background acquisition without MPU_DATA_READY_INT"
+#endif
+
+/**
+ * 1: the gyro is written into the FIFO too, 0: only the accelerometer
+ */
+#ifndef MPU_FIFO_GYRO
+#define MPU_FIFO_GYRO 0
+#endif
+
+/**
+ * FIFO sample rate 1 kHz / (1 + divider), time between two samples
+ */
+#define MPU_FIFO_SAMPLE_RATE_DIV 0
+#define MPU_FIFO_SAMPLE_US (1000 * (1 + MPU_FIFO_SAMPLE_RATE_DIV))
+
+/**
+ * bytes of one sample in the FIFO, size of the FIFO
+ */
+#if MPU_FIFO_GYRO
+#define MPU_FIFO_FRAME_LEN 12
+#else
+#define MPU_FIFO_FRAME_LEN 6
+#endif
+#define MPU_FIFO_SIZE 1024
+
+/**
+ * The FIFO is drained every MPU_FIFO_SERVICE_RATE ms, at most
+ * MPU_FIFO_BATCH_MAX samples per burst, the rest stays for the next one.
+ * A burst takes 1.5 times the samples of one service period, so a backlog
+ * is worked off. A full FIFO (170 ms of accelerometer samples, 85 ms with
+ * the gyro) has lost samples, it is reset and the time stamps start again
+ */
+#define MPU_FIFO_SERVICE_RATE 10
+#define MPU_FIFO_BATCH_MAX \
+	(MPU_FIFO_SERVICE_RATE * 1000 / MPU_FIFO_SAMPLE_US * 3 / 2)
+
+/**
+ * Bus time of one drain in us, 9 clocks per byte: the FIFO count read
+ * (5 bytes) and the burst (3 address bytes and MPU_FIFO_BATCH_MAX frames).
+ * The drain must end before the next one is due, else only every second
+ * service period drains and the FIFO runs full. At 100 kHz an accelerometer
+ * burst takes about 9 ms, with the gyro about 17 ms (one 12 byte frame
+ * takes longer than the 1 ms between two samples), so MPU_FIFO_GYRO
+ * needs MPU_I2C_FAST
+ */
+#define MPU_FIFO_DRAIN_US \
+	((5 + 3 + MPU_FIFO_BATCH_MAX * MPU_FIFO_FRAME_LEN) * 9 * 1000000 \
+			/ MPU_I2C_SPEED)
+
+#if MPU_FIFO_MODE && MPU_FIFO_DRAIN_US >= MPU_FIFO_SERVICE_RATE * 1000
+#error "FIFO drain longer than MPU_FIFO_SERVICE_RATE, MPU_FIFO_GYRO needs MPU_I2C_FAST"
+#endif
+
+/**
+ * drained samples waiting for takeBatch, power of two
+ */
+#define MPU_FIFO_QUEUE_LEN 64
+
+/**
+ * A background read which is not finished after this many ms
+ * is aborted and the i2c is initialized again,
+ * a FIFO drain is shorter than MPU_FIFO_SERVICE_RATE (MPU_FIFO_DRAIN_US)
+ */
+#if MPU_FIFO_MODE
+#define MPU_READ_TIMEOUT_MS 30
+#else
+#define MPU_READ_TIMEOUT_MS 10
+#endif
+
+/**
+ * Bus recovery after an aborted read: SCL is clocked at most
+ * MPU_RECOVERY_CLOCKS times until the sensor releases SDA, every half
+ * clock is MPU_RECOVERY_DELAY_LOOPS busy loops (about 5 us at 84 MHz)
+ */
+#define MPU_RECOVERY_CLOCKS 9
+#define MPU_RECOVERY_DELAY_LOOPS 80
+
+/**
+ * One sample of the sensor, raw values of the registers
+ */
+struct mpu6050_sample {
+	int16_t accelX;
+	int16_t accelY;
+	int16_t accelZ;
+	int16_t temperature;
+	int16_t gyroX;
+	int16_t gyroY;
+	int16_t gyroZ;
+};
+
+/**
+ * A sample drained from the FIFO, time of the sample in us,
+ * counted in sensor sample periods from the last FIFO reset,
+ * the values of sensors not in the FIFO are 0
+ */
+struct mpu6050_timed_sample {
+	uint32_t timeUs;
+	struct mpu6050_sample sample;
+};
+
+/**
+ * last sample read by readData
+ */
+extern struct mpu6050_sample mpuSample;
 
 /**
  * Angles stored
@@ -50,10 +294,24 @@ struct angles {
 
 /**
  * Used to initialize MPU6050 to read accelerometer,
+ * the i2c is set to MPU_I2C_SPEED first,
  * return 1 if it is successful else 0
  */
 extern int mpu6050_init(void);
 
+/**
+ * Used to enable the data ready interrupt of the sensor,
+ * after this INT pulses once per sample,
+ * return 1 if it is successful else 0
+ */
+extern int enableDataReady(void);
+
+/**
+ * Used to start the FIFO service (MPU_FIFO_MODE), the FIFO is enabled
+ * and reset empty by the next startRead
+ */
+extern void startFifo(void);
+
 /**
  * Used to check if controller is working
  * return 1 if is working
@@ -61,10 +319,58 @@ extern int mpu6050_init(void);
 extern int isWorking(void);
 
 /**
- * Used to read Data
+ * Used to read Data, all sensor registers in one burst,
+ * the sample is decoded and the tilt angles are calculated
  */
 extern int readData(void);
 
+/**
+ * start reading all sensor registers in the background
+ * (MPU_FIFO_MODE: draining the FIFO),
+ * return 1 if started, 0 if the last read is still running or failed
+ */
+extern int startRead(void);
+
+/**
+ * copy the newest published sample, return 1 if it was not taken before
+ */
+extern int takeSample(struct mpu6050_sample *sample);
+
+/**
+ * take the newest published sample into mpuSample and calculate
+ * the tilt angles, return 1 if there was a new sample
+ * (MPU_FIFO_MODE: all drained samples are taken, the newest is used)
+ */
+extern int processSample(void);
+
+/**
+ * background reads which failed or were aborted since start up
+ */
+extern uint32_t getReadErrors(void);
+
+/**
+ * copy at most max drained FIFO samples, oldest first,
+ * return the number of samples copied
+ */
+extern int takeBatch(struct mpu6050_timed_sample *batch, int max);
+
+/**
+ * FIFO overflows and samples dropped because the queue was full
+ * since start up
+ */
+extern uint32_t getFifoOverflows(void);
+extern uint32_t getFifoDropped(void);
+
+/**
+ * decode the SENSOR_DATA_LEN bytes of a burst into a sample
+ */
+extern void decodeSample(const uint8_t *data, struct mpu6050_sample *sample);
+
+/**
+ * calculate the tilt angles from the accelerometer values of a sample
+ */
+extern void calculateAngles(const struct mpu6050_sample *sample);
+
 /**
  * Used to print the Results
  */
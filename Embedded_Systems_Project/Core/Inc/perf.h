@@ -0,0 +1,102 @@
+/**
+ * Perf module measures the display entry points and the i2c transactions
+ * of the sensor (init, WHO_AM_I and the data burst).
+ * Every call of an instrumented function is recorded with its duration,
+ * the bytes it sent to the lcd (data bytes on the i2c)
+ * and the enable strobes it issued.
+ * Per entry point the number of calls, min, max and average duration
+ * and the total bytes and strobes are kept.
+ * The duration is counted in ticks: cpu cycles of the DWT cycle counter
+ * on target, nano seconds of the monotonic clock in the host build.
+ *
+ * Author Husnain Khan
+ */
+
+#ifndef INC_PERF_H_
+#define INC_PERF_H_
+
+#include <stdint.h>
+
+/**
+ * 1 records the display entry points, 0 compiles the instrumentation out
+ */
+#ifndef PERF_ENABLED
+#define PERF_ENABLED 1
+#endif
+
+/**
+ * Instrumented entry points
+ */
+#define PERF_REFRESH_SCREEN 0
+#define PERF_REFRESH_SLICE 1
+#define PERF_REFRESH_DMA 2
+#define PERF_CLEAR_SCREEN 3
+#define PERF_WRITE_ON_SCREEN 4
+#define PERF_WRITE_BURST 5
+#define PERF_PRESENT 6
+#define PERF_MPU_INIT 7
+#define PERF_MPU_WHO_AM_I 8
+#define PERF_MPU_BURST 9
+#define PERF_ENTRIES 10
+
+/**
+ * Longest line written by perf_Format
+ */
+#define PERF_LINE_LEN 96
+
+/**
+ * measurements of one entry point
+ */
+struct perf_entry {
+	uint32_t calls;
+	uint32_t minTicks;
+	uint32_t maxTicks;
+	uint64_t totalTicks;
+	uint32_t bytes;
+	uint32_t strobes;
+};
+
+/**
+ * start the cycle counter and clear all measurements
+ */
+extern void perf_Init(void);
+
+/**
+ * clear all measurements
+ */
+extern void perf_Reset(void);
+
+/**
+ * current time in ticks
+ */
+extern uint32_t perf_Now(void);
+
+/**
+ * ticks per micro second
+ */
+extern uint32_t perf_Ticks_Per_Us(void);
+
+/**
+ * record one call of an entry point which started at start (perf_Now),
+ * sent bytes to the lcd and issued strobes enable strobes
+ */
+extern void perf_Record(int entry, uint32_t start, uint32_t bytes,
+		uint32_t strobes);
+
+/**
+ * measurements of an entry point
+ */
+extern const struct perf_entry* perf_Get(int entry);
+
+/**
+ * name of an entry point
+ */
+extern const char* perf_Name(int entry);
+
+/**
+ * write the header (entry -1) or the measurements of one entry point
+ * as a text line into buff, return the length of the line
+ */
+extern int perf_Format(int entry, char *buff, int size);
+
+#endif /* INC_PERF_H_ */
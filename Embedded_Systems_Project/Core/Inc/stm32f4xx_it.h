@@ -58,6 +58,9 @@ void PendSV_Handler(void);
 void SysTick_Handler(void);
 void USART2_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void I2C1_EV_IRQHandler(void);
+void I2C1_ER_IRQHandler(void);
+void EXTI15_10_IRQHandler(void);
 
 /* USER CODE END EFP */
 
@@ -1,28 +1,297 @@
 #include "Dem128064B.h"
 #include "main.h"
+#include "perf.h"
 
 /**
- * display screen array 
- * 
+ * single store to the lcd bus pins, every bus phase is one GPIOC->BSRR word,
+ * the host build replaces it to feed the bus simulator
+ */
+#ifndef LCD_BUS_STORE
+#define LCD_BUS_STORE(word) (GPIOC->BSRR = (word))
+#endif
+
+/**
+ * measure an entry point with the perf module, PERF_BEGIN at the start,
+ * PERF_END before returning records duration, bytes and strobes
+ */
+#if PERF_ENABLED
+#define PERF_BEGIN() uint32_t perfStart = perf_Now(); \
+		uint32_t perfWrites = totalLcdWrites; \
+		uint32_t perfStrobes = totalLcdStrobes
+#define PERF_END(entry) perf_Record(entry, perfStart, \
+		totalLcdWrites - perfWrites, totalLcdStrobes - perfStrobes)
+#else
+#define PERF_BEGIN()
+#define PERF_END(entry)
+#endif
+
+/**
+ * BSRR bits of the control pins for D/I (command 0, data 1),
+ * the selected chips (LCD_CS_LEFT, LCD_CS_RIGHT or LCD_CS_BOTH) and enable,
+ * R/W is always reset (write) and reset always set
+ */
+#define BUS_SET_BITS(di, chips, e) ((1 << RST_pos) | ((di) << DI_pos) \
+		| (((chips) & 1) << CS1_pos) | ((((chips) >> 1) & 1) << CS2_pos) \
+		| ((e) << E_pos))
+#define BUS_CONTROL_WORD(di, chips, e) (BUS_SET_BITS(di, chips, e) \
+		| (((LCD_BUS_MASK & ~0xFF) & ~BUS_SET_BITS(di, chips, e)) << 16))
+#define BUS_CONTROL_WORDS(di, chips) \
+		{ BUS_CONTROL_WORD(di, chips, 0), BUS_CONTROL_WORD(di, chips, 1) }
+
+static const uint32_t busControlWords[2][4][2] = {
+	{ BUS_CONTROL_WORDS(0, 0), BUS_CONTROL_WORDS(0, LCD_CS_LEFT),
+		BUS_CONTROL_WORDS(0, LCD_CS_RIGHT), BUS_CONTROL_WORDS(0, LCD_CS_BOTH) },
+	{ BUS_CONTROL_WORDS(1, 0), BUS_CONTROL_WORDS(1, LCD_CS_LEFT),
+		BUS_CONTROL_WORDS(1, LCD_CS_RIGHT), BUS_CONTROL_WORDS(1, LCD_CS_BOTH) },
+};
+
+/**
+ * BSRR bit toggling enable from reset to set in a bus word
+ */
+#define BUS_ENABLE_FLIP ((1 << E_pos) | (1 << (E_pos + 16)))
+
+/**
+ * chips selected by the last set_Lcd_Address, stream_Data writes to them
+ */
+static int busChips = LCD_CS_LEFT;
+
+/**
+ * Set while present, a refresh or a gray phase step changes or sends the
+ * presented frame. They are called from the main loop and from the SysTick
+ * handler, one which interrupts another returns without touching the
+ * buffers or the send spans, its work is done by the next call
+ */
+static volatile int displayBusy = 0;
+
+/**
+ * take the display for an entry point, return 0 if it is busy
+ */
+static int lock_Display() {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	int locked = !displayBusy;
+	displayBusy = 1;
+	__set_PRIMASK(primask);
+	return locked;
+}
+
+static void unlock_Display() {
+	displayBusy = 0;
+}
+
+/**
+ * display screen arrays,
+ * packed 1 bit per pixel in the same layout as the KS0108 display RAM:
+ * 8 pages of 128 columns, every byte holds 8 rows of one column
+ * (bit 0 is the top row of the page).
+ * The moving objects are drawn into the dynamic layer, which is double
+ * buffered: the game draws into backBuffer while the refresh only reads
+ * frontBuffer, present swaps them.
+ * Banners and the score are drawn into staticLayer, which is only rebuilt
+ * when they change. The lcd shows both layers OR-ed together, the output
+ * byte is composed only for the spans which are sent.
+ * display points to the layer selected for drawing.
+ * The buffers are word aligned, the fill primitives access 4 columns at once
+ */
+static uint8_t frameBuffers[2][TOTAL_PAGES][TOTAL_COLS] __attribute__((aligned(4)));
+static uint8_t staticLayer[TOTAL_PAGES][TOTAL_COLS] __attribute__((aligned(4)));
+static uint8_t (*backBuffer)[TOTAL_COLS] = frameBuffers[0];
+static uint8_t (*frontBuffer)[TOTAL_COLS] = frameBuffers[1];
+uint8_t (*display)[TOTAL_COLS] = frameBuffers[0];
+static int drawLayer = LAYER_DYNAMIC;
+
+#if LCD_GRAYSCALE
+/**
+ * gray bit planes, the gray level of a pixel is low + 2 * high.
+ * grayStart/End are the changes of the planes since the last present,
+ * flickerStart/End the columns with pixels of level 1 or 2 (low XOR high),
+ * which change from one phase to the next
+ */
+static uint8_t grayPlanes[2][TOTAL_PAGES][TOTAL_COLS] __attribute__((aligned(4)));
+static uint8_t grayStart[TOTAL_PAGES];
+static uint8_t grayEnd[TOTAL_PAGES];
+static uint8_t flickerStart[TOTAL_PAGES];
+static uint8_t flickerEnd[TOTAL_PAGES];
+static int grayPhase = 0;
+
+/**
+ * pixels of a gray byte which are on in the current phase,
+ * level 1 in phase 0, level 2 in phases 0 and 1, level 3 always
+ */
+static inline uint8_t gray_Byte(uint8_t low, uint8_t high) {
+	switch (grayPhase) {
+	case 0:
+		return low | high;
+	case 1:
+		return high;
+	default:
+		return low & high;
+	}
+}
+#endif
+
+/**
+ * copy of what the lcd currently holds,
+ * a byte is only sent when it differs from this copy
+ */
+static uint8_t lcdContent[TOTAL_PAGES][TOTAL_COLS];
+
+/**
+ * dirty column span of every page, first and last changed column,
+ * a page is clean when dirtyStart is greater then dirtyEnd.
+ * dirtyStart/End are the changes drawn to the dynamic layer and
+ * staticStart/End the changes of the static layer since the last present,
+ * sendStart/End the changes of the output not sent to the lcd yet
+ */
+static uint8_t dirtyStart[TOTAL_PAGES];
+static uint8_t dirtyEnd[TOTAL_PAGES];
+static uint8_t staticStart[TOTAL_PAGES];
+static uint8_t staticEnd[TOTAL_PAGES];
+static uint8_t sendStart[TOTAL_PAGES];
+static uint8_t sendEnd[TOTAL_PAGES];
+
+/**
+ * 4 columns of a page accessed as one 32 bit word
+ */
+typedef uint32_t __attribute__((may_alias)) lcd_word_t;
+
+/**
+ * byte shown on the lcd, the presented dynamic layer over the static layer
+ * and the gray pixels which are on in the current phase
+ */
+static inline uint8_t output_Byte(int page, int col) {
+#if LCD_GRAYSCALE
+	return frontBuffer[page][col] | staticLayer[page][col]
+			| gray_Byte(grayPlanes[0][page][col], grayPlanes[1][page][col]);
+#else
+	return frontBuffer[page][col] | staticLayer[page][col];
+#endif
+}
+
+static void mark_Dirty(int page, int col);
+static void clear_Send_Spans(void);
+static int flush_Run(int page, int startCol, int endCol);
+
+/**
+ * number of bytes written to the lcd by the last refreshScreen
+ * and in total since start up
+ */
+static uint32_t lastRefreshWrites = 0;
+static uint32_t totalLcdWrites = 0;
+
+/**
+ * number of enable strobes since start up
+ */
+static uint32_t totalLcdStrobes = 0;
+
+/**
+ * duration of the last refreshScreen in cpu cycles, measured with the DWT cycle counter
+ */
+static uint32_t lastRefreshCycles = 0;
+
+/**
+ * Scroll of the frame being drawn, of the presented frame and the start
+ * line the lcd uses (-1 when unknown). The display array is not moved by
+ * scrolling, screen row r shows row (r + scroll) % TOTAL_ROWS of it.
+ * The start line is sent after the bytes of the presented frame, so only
+ * the rows which became visible are sent when scrolling
+ */
+static int scrollLine = 0;
+static int presentedScroll = 0;
+static int lcdScroll = -1;
+
+static int apply_Scroll(void);
+
+/**
+ * page the next refresh slice starts with and the longest slice in cpu cycles
+ */
+static int slicePage = 0;
+static uint32_t maxSliceCycles = 0;
+
+static int send_Next_Run(int page, int budget);
+
+/**
+ * retained scene, objects drawn into the dynamic layer by scene_Update.
+ * x, y and visible are the wanted state, drawnX, drawnY and drawn
+ * the state the dynamic layer shows
  */
-uint8_t display[TOTAL_ROWS][TOTAL_COLS];
+static struct scene_object {
+	const struct bitmap *sprite;
+	int16_t x;
+	int16_t y;
+	int16_t drawnX;
+	int16_t drawnY;
+	uint8_t visible;
+	uint8_t drawn;
+} sceneObjects[MAX_SCENE_OBJECTS];
+static int sceneCount = 0;
 
 /**
  * timer 10 handle Type def
  */
 extern TIM_HandleTypeDef htim10;
 
+#if LCD_DMA_REFRESH
+/**
+ * timer 1 paces the background refresh, every update event
+ * moves one word to GPIOC->BSRR with DMA2 stream 5
+ */
+extern TIM_HandleTypeDef htim1;
+extern DMA_HandleTypeDef hdma_tim1_up;
+
+/**
+ * BSRR words of one screen half of one page, one buffer is streamed
+ * while the next one is prepared
+ */
+static uint32_t dmaWords[2][LCD_DMA_SEGMENT_WORDS];
+static int dmaWordCount[2];
+static int dmaActiveBuf = 0;
+
+/**
+ * dirty spans taken over at the start of the background refresh
+ * and the next page half (page * 2 + half) to prepare
+ */
+static uint8_t dmaSpanStart[TOTAL_PAGES];
+static uint8_t dmaSpanEnd[TOTAL_PAGES];
+static int dmaNextSegment = 0;
+
+/**
+ * 1 while a background refresh is running
+ */
+static volatile int dmaRefreshBusy = 0;
+
+/**
+ * called when the background refresh is finished
+ */
+static lcd_refresh_cb_t refreshDoneCallback = 0;
+#endif
+
 /**
  * set up the screen, set reset bit, clear the screen 
  * Initilization of the display screen
  */
 void setUp() {
+	// cycle counter used to measure the refresh time
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	perf_Init();
+
 	// set the rest bit of the lcd
 	set_Reset_Bit();
 	clear_Screen();
+	apply_Scroll();
 
 	// init display Array to 0
 	init_DisplayArray();
+	clear_Dirty();
+	clear_Send_Spans();
+#if LCD_GRAYSCALE
+	for (int i = 0; i < TOTAL_PAGES; i++) {
+		flickerStart[i] = TOTAL_COLS;
+		flickerEnd[i] = 0;
+	}
+#endif
 
 	// set prev position to 0 as its the starting position
 	prevPos.prev_Row = 0;
@@ -37,27 +306,122 @@ void setUp() {
  * resent the enable
  */
 void toggle_Enable_Lcd() {
+#if LCD_BUSY_POLLING
+	set_Enable();
+	getShortDelay();
+	reset_Enable();
+	wait_Lcd_Ready();
+#else
 	set_Enable();
 	getDelay();
 	reset_Enable();
 	getDelay();
+#endif
+	totalLcdStrobes++;
+}
+
+/**
+ * one GPIOC->BSRR word for a bus state, data pins, D/I, chip selects and enable
+ * are set or reset in a single store, R/W is always 0 (write), reset stays 1.
+ * The control bits come from busControlWords, the data pins are set
+ * with the low and reset with the high half of the word
+ */
+static inline uint32_t lcd_Bsrr_Word(uint8_t data, int dataMode, int chips,
+		int enable) {
+	return busControlWords[dataMode][chips][enable] | data
+			| ((uint32_t) (uint8_t) ~data << 16);
+}
+
+/**
+ * Write one command (dataMode 0) or data byte to the selected chips.
+ * Every phase of the write is one store of a complete bus word:
+ * set up data, D/I, R/W and chip selects with enable low, enable high,
+ * enable low. The port is never read, so other PORTC pins are not touched.
+ * getShortDelay between the setup and the rising enable edge covers
+ * the address setup time of the lcd (tAS, about 140 ns)
+ */
+static void lcd_Bus_Write(uint8_t value, int dataMode, int chips) {
+	uint32_t word = lcd_Bsrr_Word(value, dataMode, chips, 0);
+	LCD_BUS_STORE(word);
+	getShortDelay();
+	LCD_BUS_STORE(word ^ BUS_ENABLE_FLIP);
+#if LCD_BUSY_POLLING
+	getShortDelay();
+	LCD_BUS_STORE(word);
+	wait_Lcd_Ready();
+#else
+	getDelay();
+	LCD_BUS_STORE(word);
+	getDelay();
+#endif
+	totalLcdStrobes++;
 }
 
 /**
  * used to generate delay of 5 micro seconds using timer 10
  */
-int getDelay() {
+void getDelay() {
 	HAL_TIM_Base_Start(&htim10);
 	__HAL_TIM_SET_COUNTER(&htim10, 0);  // set the counter value a 0
 	while (__HAL_TIM_GET_COUNTER(&htim10) < 5)
 		;
 }
 
+/**
+ * short busy loop which covers the minimum enable pulse width
+ * and the data delay time of the lcd (about 0.5 micro seconds)
+ */
+void getShortDelay() {
+	for (volatile int i = 0; i < LCD_SHORT_DELAY_LOOPS; i++)
+		;
+}
+
+/**
+ * wait until the selected controller clears its busy flag,
+ * the data pins are switched to input and the status register is read
+ * (R/W high, D/I low). If the flag does not clear within
+ * LCD_BUSY_TIMEOUT_US the fixed delay of getDelay is used instead.
+ * The data pins are switched back to output and DI is restored afterwards
+ */
+void wait_Lcd_Ready() {
+	uint32_t oldOdr = GPIOC->ODR;
+	uint32_t chips = oldOdr & ((1 << CS1_pos) | (1 << CS2_pos));
+
+	// PC0 - PC7 to input
+	GPIOC->MODER &= ~0xFFFF;
+
+	// with both chips selected (fill_Screen) both would drive the data bus,
+	// so the status is read from one chip after the other
+	for (int cs = CS1_pos; cs <= CS2_pos; cs++) {
+		if ((chips & (1 << cs)) == 0) {
+			continue;
+		}
+		uint32_t others = ((1 << CS1_pos) | (1 << CS2_pos)) & ~(1 << cs);
+		LCD_BUS_STORE((1 << RW_pos) | (1 << cs) | (((1 << DI_pos) | others) << 16));
+
+		HAL_TIM_Base_Start(&htim10);
+		__HAL_TIM_SET_COUNTER(&htim10, 0);
+		int busy = 1;
+		while (busy && __HAL_TIM_GET_COUNTER(&htim10) < LCD_BUSY_TIMEOUT_US) {
+			set_Enable();
+			getShortDelay();
+			busy = (GPIOC->IDR & (1 << LCD_BUSY_BIT)) != 0;
+			reset_Enable();
+			getShortDelay();
+		}
+	}
+
+	// PC0 - PC7 back to output, R/W, D/I and chip select as before
+	uint32_t restore = oldOdr & LCD_BUS_MASK & ~(1 << E_pos);
+	LCD_BUS_STORE(restore | ((LCD_BUS_MASK & ~restore) << 16));
+	GPIOC->MODER |= 0x5555;
+}
+
 /**
  * Used to set the reset bit
  */
 void set_Reset_Bit() {
-	GPIOC->ODR |= 1 << RST_pos;
+	LCD_BUS_STORE(1 << RST_pos);
 }
 
 /**
@@ -65,14 +429,14 @@ void set_Reset_Bit() {
  * 0100
  */
 void set_Enable() {
-	GPIOC->ODR |= 1 << E_pos;
+	LCD_BUS_STORE(1 << E_pos);
 }
 
 /**
  * reset enable to 0
  */
 void reset_Enable() {
-	GPIOC->ODR &= ~(1 << (E_pos));
+	LCD_BUS_STORE(1 << (E_pos + 16));
 }
 
 /**
@@ -80,39 +444,35 @@ void reset_Enable() {
  * TURN_ON_SCREEN which is to be written on the data pins by OR operation
  */
 void turn_On_Screen() {
-	GPIOC->ODR = (GPIOC->ODR & 0xFF00) | TURN_ON_SCREEEN;
+	send_Data(TURN_ON_SCREEEN);
 }
 
 /**
  * Set the control buss to write
  */
 void set_Control_Buss_To_Write() {
-	GPIOC->ODR |= 1 << DI_pos;
-	GPIOC->ODR &= ~(1 << (RW_pos));
+	LCD_BUS_STORE((1 << DI_pos) | (1 << (RW_pos + 16)));
 }
 
 /**
  * DI and R/W to 0
  */
 void display_ON_OFF_Reg() {
-	GPIOC->ODR &= ~(1 << (DI_pos));
-	GPIOC->ODR &= ~(1 << (RW_pos));
+	LCD_BUS_STORE((1 << (DI_pos + 16)) | (1 << (RW_pos + 16)));
 }
 
 /**
  * Selecting the side of the Screen
  */
 void set_Left_Side_Screen() {
-	GPIOC->ODR |= 1 << CS1_pos;
-	GPIOC->ODR &= ~(1 << (CS2_pos));
+	LCD_BUS_STORE((1 << CS1_pos) | (1 << (CS2_pos + 16)));
 }
 
 /**
  * set the right side of the screen
  */
 void set_Right_Side_Screen() {
-	GPIOC->ODR &= ~(1 << (CS1_pos));
-	GPIOC->ODR |= 1 << (CS2_pos);
+	LCD_BUS_STORE((1 << (CS1_pos + 16)) | (1 << CS2_pos));
 }
 
 /**
@@ -120,54 +480,240 @@ void set_Right_Side_Screen() {
  * used for clearing screen
  */
 void set_Both_Side_Screen() {
-	GPIOC->ODR |= 1 << (CS1_pos);
-	GPIOC->ODR |= 1 << (CS2_pos);
+	LCD_BUS_STORE((1 << CS1_pos) | (1 << CS2_pos));
 }
 
 /**
  * Clear screen, write 0 to all pixels 
  */
 void clear_Screen() {
-	for (int i = 0; i < 8; i++) {
-		for (int j = 0; j < 64; j++) {
-			write_On_Screen(i, j, 0);
+	PERF_BEGIN();
+	fill_Screen(0);
+	PERF_END(PERF_CLEAR_SCREEN);
+}
+
+/**
+ * Fill one page of the lcd with pattern, both chips are selected so
+ * they take the same commands and every data strobe writes one column
+ * of each half: 3 commands and 64 data strobes for 128 columns
+ */
+static void fill_Lcd_Page(int page, uint8_t pattern) {
+	lcd_Bus_Write(TURN_ON_SCREEEN, 0, LCD_CS_BOTH);
+	lcd_Bus_Write(PAGE_SEL_MASK | page, 0, LCD_CS_BOTH);
+	lcd_Bus_Write(COL_SEL_MASK, 0, LCD_CS_BOTH);
+
+	// the column address auto increments after every data byte
+	for (int j = 0; j < MAX_COLS_LCD; j++) {
+		lcd_Bus_Write(pattern, 1, LCD_CS_BOTH);
+	}
+	for (int j = 0; j < TOTAL_COLS; j++) {
+		lcdContent[page][j] = pattern;
+	}
+	totalLcdWrites += TOTAL_COLS;
+}
+
+/**
+ * Fill the whole lcd with pattern, every byte of the screen is set to it,
+ * 8 x 67 strobes. The display array is not changed, every page where it
+ * differs from pattern is sent again by the next refresh
+ */
+void fill_Screen(uint8_t pattern) {
+	for (int i = 0; i < TOTAL_PAGES; i++) {
+		fill_Lcd_Page(i, pattern);
+		sendStart[i] = 0;
+		sendEnd[i] = TOTAL_COLS - 1;
+	}
+}
+
+/**
+ * 1 if every output byte of the page is the same
+ */
+static int page_Is_Uniform(int page) {
+	uint8_t value = output_Byte(page, 0);
+	for (int j = 1; j < TOTAL_COLS; j++) {
+		if (output_Byte(page, j) != value) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * mark the given column of a page as changed,
+ * the dirty span of the page is grown to include the column
+ */
+static void mark_Dirty(int page, int col) {
+	uint8_t *start = drawLayer == LAYER_STATIC ? staticStart : dirtyStart;
+	uint8_t *end = drawLayer == LAYER_STATIC ? staticEnd : dirtyEnd;
+#if LCD_GRAYSCALE
+	if (drawLayer == LAYER_GRAY_LOW || drawLayer == LAYER_GRAY_HIGH) {
+		start = grayStart;
+		end = grayEnd;
+	}
+#endif
+	if (col < start[page]) {
+		start[page] = col;
+	}
+	if (col > end[page]) {
+		end[page] = col;
+	}
+}
+
+/**
+ * set all pages to clean
+ */
+void clear_Dirty() {
+	for (int i = 0; i < TOTAL_PAGES; i++) {
+		dirtyStart[i] = TOTAL_COLS;
+		dirtyEnd[i] = 0;
+		staticStart[i] = TOTAL_COLS;
+		staticEnd[i] = 0;
+#if LCD_GRAYSCALE
+		grayStart[i] = TOTAL_COLS;
+		grayEnd[i] = 0;
+#endif
+	}
+}
+
+/**
+ * nothing of the front buffer is left to send
+ */
+static void clear_Send_Spans() {
+	for (int i = 0; i < TOTAL_PAGES; i++) {
+		sendStart[i] = TOTAL_COLS;
+		sendEnd[i] = 0;
+	}
+}
+
+#if LCD_GRAYSCALE
+/**
+ * find the columns of a page with pixels of level 1 or 2
+ */
+static void update_Flicker_Span(int page) {
+	flickerStart[page] = TOTAL_COLS;
+	flickerEnd[page] = 0;
+	for (int j = 0; j < TOTAL_COLS; j++) {
+		if (grayPlanes[0][page][j] != grayPlanes[1][page][j]) {
+			if (j < flickerStart[page]) {
+				flickerStart[page] = j;
+			}
+			flickerEnd[page] = j;
 		}
 	}
 }
 
+/**
+ * Step to the next frame phase. The output of the columns with dimmed pixels
+ * changes, they are added to the spans the refresh sends, all other
+ * columns stay as they are. While a background refresh still reads the
+ * spans the phase is not changed and 0 is returned
+ */
+int gray_Next_Phase() {
+#if LCD_DMA_REFRESH
+	if (dmaRefreshBusy) {
+		return 0;
+	}
+#endif
+	if (!lock_Display()) {
+		return 0;
+	}
+	grayPhase = (grayPhase + 1) % GRAY_PHASES;
+	for (int i = 0; i < TOTAL_PAGES; i++) {
+		if (flickerStart[i] > flickerEnd[i]) {
+			continue;
+		}
+		if (flickerStart[i] < sendStart[i]) {
+			sendStart[i] = flickerStart[i];
+		}
+		if (flickerEnd[i] > sendEnd[i]) {
+			sendEnd[i] = flickerEnd[i];
+		}
+	}
+	unlock_Display();
+	return 1;
+}
+#endif
+
+/**
+ * Show the drawn frame, the back and front buffer are swapped
+ * and the changes drawn since the last present are handed over to the refresh.
+ * The new back buffer is brought up to date by copying only the changed spans,
+ * so the game keeps drawing on top of the last frame.
+ * While a background refresh still reads the front buffer or a present or
+ * refresh is interrupted nothing is swapped,
+ * the changes stay in the back buffer and 0 is returned
+ */
+int present() {
+#if LCD_DMA_REFRESH
+	if (dmaRefreshBusy) {
+		return 0;
+	}
+#endif
+	if (!lock_Display()) {
+		return 0;
+	}
+	PERF_BEGIN();
+	uint8_t (*drawn)[TOTAL_COLS] = backBuffer;
+	backBuffer = frontBuffer;
+	frontBuffer = drawn;
+	presentedScroll = scrollLine;
+	if (drawLayer == LAYER_DYNAMIC) {
+		display = backBuffer;
+	}
+
+	for (int i = 0; i < TOTAL_PAGES; i++) {
+		for (int j = dirtyStart[i]; j <= dirtyEnd[i]; j++) {
+			backBuffer[i][j] = frontBuffer[i][j];
+		}
+		// changes of the static layer only have to be sent
+		int start = dirtyStart[i] < staticStart[i] ? dirtyStart[i] : staticStart[i];
+		int end = dirtyEnd[i] > staticEnd[i] ? dirtyEnd[i] : staticEnd[i];
+#if LCD_GRAYSCALE
+		if (grayStart[i] <= grayEnd[i]) {
+			update_Flicker_Span(i);
+			start = grayStart[i] < start ? grayStart[i] : start;
+			end = grayEnd[i] > end ? grayEnd[i] : end;
+		}
+#endif
+		if (start > end) {
+			continue;
+		}
+		if (start < sendStart[i]) {
+			sendStart[i] = start;
+		}
+		if (end > sendEnd[i]) {
+			sendEnd[i] = end;
+		}
+	}
+	clear_Dirty();
+	PERF_END(PERF_PRESENT);
+	unlock_Display();
+	return 1;
+}
+
 /**
  * init Display array, 
  * set the display 2d array to default 0 values 
- * which means screen is clear 
+ * which means screen is clear, cleared 4 columns at a time
  */
 void init_DisplayArray() {
-	for (int i = 0; i < 64; i++) {
-		for (int j = 0; j < 128; j++) {
-			display[i][j] = 0;
-		}
-	}
+	fill_Rect(0, 0, TOTAL_COLS, TOTAL_ROWS, ROP_AND_NOT);
 }
 
+/**
+ * the ball, 3 x 3 pixels
+ */
+static const uint8_t ballData[] = { 0x07, 0x07, 0x07 };
+
+const struct bitmap ballSprite = { 3, 3, ballData };
+
 /**
  * Used to set the ball 3 x 3 at the given position
  * setOrClear if 1 then set else clear the ball
  * from the given position
  */
 void set_Ball_To_Position(int row, int col, int setOrClear) {
-	int allPos[9][2] = { { row, col }, { row + 1, col + 1 },
-			{ row - 1, col - 1 }, { row + 1, col - 1 }, { row - 1, col + 1 }, {
-					row, col + 1 }, { row + 1, col }, { row - 1, col }, { row,
-					col - 1 }, };
-
-	for (int i = 0; i < 9; i++) {
-		int row1 = *(&(allPos[i])[0]);
-		int col1 = *(&(allPos[i])[1]);
-		if (setOrClear == 1 && row1 >= 0 && col1 >= 0) {
-			writeToDisplayArr(row1, col1);
-		} else if (row1 >= 0 && col1 >= 0) {
-			clearDisplayArr(row1, col1);
-		}
-	}
+	blit(&ballSprite, col - 1, row - 1, setOrClear == 1 ? ROP_OR : ROP_AND_NOT);
 }
 
 /**
@@ -175,40 +721,500 @@ void set_Ball_To_Position(int row, int col, int setOrClear) {
  * set the data which is in display array on the screen
  */
 void refreshScreen() {
-	// i is for Col, j is for the pages, K is for the rows in the page
-	uint8_t toSendData = 0;
-	int var = 0;
-	for (int i = 0; i < TOTAL_COLS; i++) {
-		for (int j = 0; j < PAGE_LEN; j++) {
-			var = j * PAGE_LEN;
-			for (int k = var + PAGE_LEN; k >= var; k--) {
-				// shift one
-				if (display[k][i] == 1) {
-					toSendData = toSendData << 1;
-					toSendData |= 1;
-				} else {
-					// shift 0
-					toSendData = toSendData << 1;
+#if LCD_DMA_REFRESH
+	// the bus belongs to the background refresh
+	if (dmaRefreshBusy) {
+		return;
+	}
+#endif
+	if (!lock_Display()) {
+		return;
+	}
+	uint32_t startCycles = DWT->CYCCNT;
+	PERF_BEGIN();
+
+	// the display array already has the page layout of the lcd,
+	// so every byte can be sent as it is. Only the dirty span of
+	// every page is visited and only bytes the lcd does not hold yet are sent
+	// Changed bytes which are close to each other are sent as one burst,
+	// resending up to MAX_BURST_GAP unchanged bytes is cheaper then
+	// setting the address again
+	lastRefreshWrites = 0;
+	for (int i = 0; i < TOTAL_PAGES; i++) {
+		// a page which becomes one value, like a cleared banner, is filled
+		// on both chips at once when that is cheaper then sending the runs
+		if (sendEnd[i] - sendStart[i] >= MAX_COLS_LCD && page_Is_Uniform(i)) {
+			int changed = 0;
+			for (int j = sendStart[i]; j <= sendEnd[i]; j++) {
+				changed += output_Byte(i, j) != lcdContent[i][j];
+			}
+			if (changed > MAX_COLS_LCD) {
+				fill_Lcd_Page(i, output_Byte(i, 0));
+				lastRefreshWrites += TOTAL_COLS;
+				continue;
+			}
+		}
+		int runStart = -1;
+		int runEnd = -1;
+		for (int j = sendStart[i]; j <= sendEnd[i]; j++) {
+			if (output_Byte(i, j) == lcdContent[i][j]) {
+				continue;
+			}
+			if (runStart >= 0 && j - runEnd > MAX_BURST_GAP + 1) {
+				lastRefreshWrites += flush_Run(i, runStart, runEnd);
+				runStart = -1;
+			}
+			if (runStart < 0) {
+				runStart = j;
+			}
+			runEnd = j;
+		}
+		if (runStart >= 0) {
+			lastRefreshWrites += flush_Run(i, runStart, runEnd);
+		}
+	}
+	clear_Send_Spans();
+	apply_Scroll();
+
+	lastRefreshCycles = DWT->CYCCNT - startCycles;
+	PERF_END(PERF_REFRESH_SCREEN);
+	unlock_Display();
+}
+
+/**
+ * send the columns startCol to endCol of the page as one burst
+ * and take them over in the lcd copy, return the number of bytes sent
+ */
+static int flush_Run(int page, int startCol, int endCol) {
+	int len = endCol - startCol + 1;
+	for (int j = startCol; j <= endCol; j++) {
+		lcdContent[page][j] = output_Byte(page, j);
+	}
+	write_Burst_On_Screen(page, startCol, &lcdContent[page][startCol], len);
+	return len;
+}
+
+/**
+ * Send the next slice of the presented frame.
+ * The send span of a page is used as cursor: every sent run moves
+ * sendStart behind it, so the next slice resumes there and a present
+ * in between only widens the spans. At most LCD_SLICE_WRITES bus writes
+ * are made, a run which does not fit is cut and continued by the next slice.
+ * Return 1 when no page has anything left to send
+ */
+int refresh_Screen_Slice() {
+#if LCD_DMA_REFRESH
+	if (dmaRefreshBusy) {
+		return 0;
+	}
+#endif
+	if (!lock_Display()) {
+		return 0;
+	}
+	uint32_t startCycles = DWT->CYCCNT;
+	PERF_BEGIN();
+	int budget = LCD_SLICE_WRITES;
+	int cleanPages = 0;
+
+	while (budget > LCD_ADDRESS_WRITES && cleanPages < TOTAL_PAGES) {
+		if (sendStart[slicePage] > sendEnd[slicePage]) {
+			slicePage = (slicePage + 1) % TOTAL_PAGES;
+			cleanPages++;
+			continue;
+		}
+		budget -= send_Next_Run(slicePage, budget);
+	}
+	// the start line once the whole frame is sent
+	if (cleanPages == TOTAL_PAGES && budget > 0) {
+		budget -= apply_Scroll();
+	}
+
+	uint32_t cycles = DWT->CYCCNT - startCycles;
+	if (cycles > maxSliceCycles) {
+		maxSliceCycles = cycles;
+	}
+	PERF_END(PERF_REFRESH_SLICE);
+	unlock_Display();
+	return cleanPages == TOTAL_PAGES && lcdScroll == presentedScroll;
+}
+
+/**
+ * Send the next run of changed bytes of one page, the run ends
+ * at a gap of more then MAX_BURST_GAP unchanged bytes, at the chip border
+ * or when the budget of bus writes is used up.
+ * Return the bus writes made
+ */
+static int send_Next_Run(int page, int budget) {
+	int start = sendStart[page];
+	int end = sendEnd[page];
+	while (start <= end && output_Byte(page, start) == lcdContent[page][start]) {
+		start++;
+	}
+	if (start > end) {
+		sendStart[page] = TOTAL_COLS;
+		sendEnd[page] = 0;
+		return 0;
+	}
+
+	int limit = (start / MAX_COLS_LCD + 1) * MAX_COLS_LCD - 1;
+	if (limit > end) {
+		limit = end;
+	}
+	if (limit > start + budget - LCD_ADDRESS_WRITES - 1) {
+		limit = start + budget - LCD_ADDRESS_WRITES - 1;
+	}
+	int runEnd = start;
+	for (int j = start + 1; j <= limit && j - runEnd <= MAX_BURST_GAP + 1; j++) {
+		if (output_Byte(page, j) != lcdContent[page][j]) {
+			runEnd = j;
+		}
+	}
+
+	uint32_t strobes = totalLcdStrobes;
+	flush_Run(page, start, runEnd);
+	sendStart[page] = runEnd + 1;
+	if (sendStart[page] > end) {
+		sendStart[page] = TOTAL_COLS;
+		sendEnd[page] = 0;
+	}
+	return totalLcdStrobes - strobes;
+}
+
+/**
+ * longest refresh slice since start up in micro seconds
+ */
+uint32_t get_Max_Slice_Time_Us() {
+	return maxSliceCycles / (SystemCoreClock / 1000000);
+}
+
+/**
+ * number of bytes sent to the lcd by the last refreshScreen
+ */
+uint32_t get_Last_Refresh_Writes() {
+	return lastRefreshWrites;
+}
+
+/**
+ * number of bytes sent to the lcd since start up
+ */
+uint32_t get_Total_Lcd_Writes() {
+	return totalLcdWrites;
+}
+
+/**
+ * number of enable strobes since start up
+ */
+uint32_t get_Total_Lcd_Strobes() {
+	return totalLcdStrobes;
+}
+
+/**
+ * duration of the last refreshScreen in micro seconds,
+ * used to compare the fixed delay and the busy flag polling bus
+ */
+uint32_t get_Last_Refresh_Time_Us() {
+	return lastRefreshCycles / (SystemCoreClock / 1000000);
+}
+
+/**
+ * byte of the presented frame at the given page and column,
+ * this is what the lcd shows after the next refresh
+ */
+uint8_t get_Output_Byte(int page, int col) {
+	return output_Byte(page, col);
+}
+
+/**
+ * select the layer the drawing functions draw into,
+ * LAYER_DYNAMIC for moving objects or LAYER_STATIC for banners and the score
+ */
+void select_Layer(int layer) {
+	drawLayer = layer;
+	display = layer == LAYER_STATIC ? staticLayer : backBuffer;
+#if LCD_GRAYSCALE
+	if (layer == LAYER_GRAY_LOW || layer == LAYER_GRAY_HIGH) {
+		display = grayPlanes[layer - LAYER_GRAY_LOW];
+	}
+#endif
+}
+
+/**
+ * mark every byte as changed, the next refresh sends the whole screen.
+ * Used when the content of the lcd is not known anymore
+ */
+void invalidate_Screen() {
+	for (int i = 0; i < TOTAL_PAGES; i++) {
+		for (int j = 0; j < TOTAL_COLS; j++) {
+			lcdContent[i][j] = ~output_Byte(i, j);
+		}
+		sendStart[i] = 0;
+		sendEnd[i] = TOTAL_COLS - 1;
+	}
+	lcdScroll = -1;
+}
+
+/**
+ * set the start line of both chips to the scroll of the presented frame,
+ * called when all bytes of the frame are sent, return the bus writes made
+ */
+static int apply_Scroll() {
+	if (lcdScroll == presentedScroll) {
+		return 0;
+	}
+	lcd_Bus_Write(START_LINE_MASK | presentedScroll, 0, LCD_CS_BOTH);
+	lcdScroll = presentedScroll;
+	return 1;
+}
+
+/**
+ * scroll the screen from the next presented frame on,
+ * screen row r shows row (r + line) % TOTAL_ROWS of the display array
+ */
+void set_Scroll(int line) {
+	scrollLine = ((line % TOTAL_ROWS) + TOTAL_ROWS) % TOTAL_ROWS;
+}
+
+int get_Scroll() {
+	return scrollLine;
+}
+
+int get_Presented_Scroll() {
+	return presentedScroll;
+}
+
+/**
+ * row of the display array shown at a row of the screen
+ */
+int scroll_Row(int row) {
+	return (row + scrollLine) % TOTAL_ROWS;
+}
+
+/**
+ * Scroll by lines, positive lines move the content up and new rows become
+ * visible at the bottom, negative lines move it down and they become visible
+ * at the top. The new rows are the ones which just left the screen at the
+ * other edge, they are cleared in the selected layer, all other rows keep
+ * their place in the display array and are not sent again.
+ * Return the display array row shown at the top most new row
+ */
+int scroll_Lines(int lines) {
+	int count = lines < 0 ? -lines : lines;
+	count = count > TOTAL_ROWS ? TOTAL_ROWS : count;
+	set_Scroll(scrollLine + lines);
+	int first = scroll_Row(lines > 0 ? TOTAL_ROWS - count : 0);
+
+	// the band may wrap around the bottom of the display array
+	int height = TOTAL_ROWS - first < count ? TOTAL_ROWS - first : count;
+	fill_Rect(0, first, TOTAL_COLS, height, ROP_AND_NOT);
+	fill_Rect(0, 0, TOTAL_COLS, count - height, ROP_AND_NOT);
+	return first;
+}
+
+/**
+ * Byte the screen shows at page and column after the next refresh,
+ * the rows of a screen page come from up to two pages of the output
+ */
+uint8_t get_Screen_Byte(int page, int col) {
+	int row = (page * PAGE_LEN + presentedScroll) % TOTAL_ROWS;
+	int shift = row % PAGE_LEN;
+	int first = row / PAGE_LEN;
+	uint8_t value = output_Byte(first, col) >> shift;
+	if (shift != 0) {
+		value |= output_Byte((first + 1) % TOTAL_PAGES, col)
+				<< (PAGE_LEN - shift);
+	}
+	return value;
+}
+
+#if LCD_DMA_REFRESH
+/**
+ * add the three words of one bus write (setup, enable high, enable low)
+ */
+static int add_Dma_Write(uint32_t *words, int count, uint8_t data,
+		int dataMode, int chips) {
+	words[count++] = lcd_Bsrr_Word(data, dataMode, chips, 0);
+	words[count++] = lcd_Bsrr_Word(data, dataMode, chips, 1);
+	words[count++] = lcd_Bsrr_Word(data, dataMode, chips, 0);
+	return count;
+}
+
+/**
+ * prepare the next page half which has changed bytes into the given buffer,
+ * the bytes are taken over in the lcd copy as they are sent from this buffer.
+ * When all pages are prepared the start line follows as the last segment,
+ * so it is not written by the cpu from the DMA interrupt.
+ * Return the number of words, 0 if nothing is left to send
+ */
+static int prepare_Dma_Segment(int buf) {
+	while (dmaNextSegment < TOTAL_PAGES * 2) {
+		int page = dmaNextSegment / 2;
+		int half = dmaNextSegment % 2;
+		dmaNextSegment++;
+
+		int first = -1;
+		int last = -1;
+		int from = half * MAX_COLS_LCD;
+		int to = from + MAX_COLS_LCD - 1;
+		if (from < dmaSpanStart[page]) {
+			from = dmaSpanStart[page];
+		}
+		if (to > dmaSpanEnd[page]) {
+			to = dmaSpanEnd[page];
+		}
+		for (int j = from; j <= to; j++) {
+			if (output_Byte(page, j) != lcdContent[page][j]) {
+				if (first < 0) {
+					first = j;
 				}
+				last = j;
 			}
-			write_On_Screen(j, i, toSendData);
 		}
+		if (first < 0) {
+			continue;
+		}
+
+		int chips = half == 0 ? LCD_CS_LEFT : LCD_CS_RIGHT;
+		uint32_t *words = dmaWords[buf];
+		int count = 0;
+		count = add_Dma_Write(words, count, TURN_ON_SCREEEN, 0, chips);
+		count = add_Dma_Write(words, count, PAGE_SEL_MASK | page, 0, chips);
+		count = add_Dma_Write(words, count,
+				COL_SEL_MASK | (first % MAX_COLS_LCD), 0, chips);
+		for (int j = first; j <= last; j++) {
+			lcdContent[page][j] = output_Byte(page, j);
+			count = add_Dma_Write(words, count, lcdContent[page][j], 1,
+					chips);
+		}
+
+		lastRefreshWrites += last - first + 1;
+		totalLcdWrites += last - first + 1;
+		totalLcdStrobes += last - first + 4;
+		return count;
+	}
+	if (dmaNextSegment == TOTAL_PAGES * 2 && lcdScroll != presentedScroll) {
+		dmaNextSegment++;
+		lcdScroll = presentedScroll;
+		totalLcdStrobes++;
+		return add_Dma_Write(dmaWords[buf], 0,
+				START_LINE_MASK | presentedScroll, 0, LCD_CS_BOTH);
+	}
+	return 0;
+}
+
+static void dma_Refresh_Complete(DMA_HandleTypeDef *hdma);
+static void dma_Refresh_Error(DMA_HandleTypeDef *hdma);
+
+/**
+ * stream the given buffer to GPIOC->BSRR, paced by the timer 1 update event
+ */
+static void start_Dma_Segment(int buf) {
+	dmaActiveBuf = buf;
+	hdma_tim1_up.XferCpltCallback = dma_Refresh_Complete;
+	hdma_tim1_up.XferErrorCallback = dma_Refresh_Error;
+	HAL_DMA_Start_IT(&hdma_tim1_up, (uint32_t) dmaWords[buf],
+			(uint32_t) &GPIOC->BSRR, dmaWordCount[buf]);
+	__HAL_TIM_ENABLE_DMA(&htim1, TIM_DMA_UPDATE);
+	__HAL_TIM_ENABLE(&htim1);
+}
+
+/**
+ * stop timer 1 and report the end of the refresh
+ */
+static void finish_Dma_Refresh() {
+	__HAL_TIM_DISABLE(&htim1);
+	__HAL_TIM_DISABLE_DMA(&htim1, TIM_DMA_UPDATE);
+	dmaRefreshBusy = 0;
+	if (refreshDoneCallback != 0) {
+		refreshDoneCallback();
+	}
+}
+
+/**
+ * DMA transfer complete, start the already prepared next segment
+ * and prepare the one after it while the bus is busy
+ */
+static void dma_Refresh_Complete(DMA_HandleTypeDef *hdma) {
+	int next = dmaActiveBuf ^ 1;
+	if (dmaWordCount[next] > 0) {
+		start_Dma_Segment(next);
+		dmaWordCount[next ^ 1] = prepare_Dma_Segment(next ^ 1);
+	} else {
+		finish_Dma_Refresh();
 	}
 }
 
+/**
+ * DMA error, the lcd content is unknown now so everything is sent again
+ */
+static void dma_Refresh_Error(DMA_HandleTypeDef *hdma) {
+	HAL_DMA_Abort_IT(hdma);
+	invalidate_Screen();
+	finish_Dma_Refresh();
+}
+
+/**
+ * Start a background refresh, the changed bytes are sent by DMA
+ * while the cpu continues. Return 1 if the refresh was started,
+ * 0 if the previous refresh is still running or the display is busy
+ * (the changes are kept for the next refresh)
+ */
+int refresh_Screen_Dma() {
+	if (dmaRefreshBusy || !lock_Display()) {
+		return 0;
+	}
+	PERF_BEGIN();
+	for (int i = 0; i < TOTAL_PAGES; i++) {
+		dmaSpanStart[i] = sendStart[i];
+		dmaSpanEnd[i] = sendEnd[i];
+	}
+	clear_Send_Spans();
+	lastRefreshWrites = 0;
+	dmaNextSegment = 0;
+
+	// both buffers are ready before the first transfer starts
+	dmaWordCount[0] = prepare_Dma_Segment(0);
+	dmaWordCount[1] = prepare_Dma_Segment(1);
+	if (dmaWordCount[0] == 0) {
+		PERF_END(PERF_REFRESH_DMA);
+		unlock_Display();
+		if (refreshDoneCallback != 0) {
+			refreshDoneCallback();
+		}
+		return 1;
+	}
+	dmaRefreshBusy = 1;
+	start_Dma_Segment(0);
+	// the cpu time to start, the bytes of the first two segments
+	PERF_END(PERF_REFRESH_DMA);
+	unlock_Display();
+	return 1;
+}
+
+/**
+ * 1 while a background refresh is running
+ */
+int refresh_In_Progress() {
+	return dmaRefreshBusy;
+}
+
+/**
+ * set the function which is called when a background refresh is finished,
+ * it is called from the DMA interrupt
+ */
+void set_Refresh_Done_Callback(lcd_refresh_cb_t callback) {
+	refreshDoneCallback = callback;
+}
+#endif
+
 /**
  * a function to draw a straight vertical line from given point
- * if setClear is 1 then set the position else clear the position
+ * if setClear is 1 then set the position else clear the position,
+ * one masked byte per page
  */
 void draw_Vert_Line(uint8_t startRow, int startCol, uint8_t verticalLen,
 		uint8_t setClear) {
-	uint8_t valueToSet = 0;
-	if (setClear == 1) {
-		valueToSet = 1;
-	}
-	for (int i = 0; i < verticalLen; i++) {
-		display[startRow + i][startCol] = valueToSet;
-	}
+	fill_Rect(startCol, startRow, 1, verticalLen,
+			setClear == 1 ? ROP_OR : ROP_AND_NOT);
 }
 
 /**
@@ -241,398 +1247,763 @@ int ballIsOnLowerLine(int lineColPos) {
 }
 
 /**
- * Used to draw Horizontal line
+ * Used to draw Horizontal line, 4 columns at a time
  */
 void draw_Horiz_Line(uint8_t startRow, uint8_t startCol, uint8_t horizonLen) {
-	for (int i = 0; i < horizonLen; i++) {
-		display[startRow][startCol + i] = 1;
-	}
+	fill_Rect(startCol, startRow, horizonLen, 1, ROP_OR);
 }
 
 /**
- * Write 1 to display array
+ * Write 1 to display array,
+ * positions outside of the screen are ignored
  */
 void writeToDisplayArr(int row, int col) {
-	display[row][col] = 1;
+	if (row < 0 || row >= TOTAL_ROWS || col < 0 || col >= TOTAL_COLS) {
+		return;
+	}
+	uint8_t *pos = &display[row / PAGE_LEN][col];
+	uint8_t newValue = *pos | (1 << (row % PAGE_LEN));
+	if (newValue != *pos) {
+		*pos = newValue;
+		mark_Dirty(row / PAGE_LEN, col);
+	}
 }
 
 /**
- * clear the given position from the array
+ * clear the given position from the array,
+ * positions outside of the screen are ignored
  */
 void clearDisplayArr(int row, int col) {
-	display[row][col] = 0;
+	if (row < 0 || row >= TOTAL_ROWS || col < 0 || col >= TOTAL_COLS) {
+		return;
+	}
+	uint8_t *pos = &display[row / PAGE_LEN][col];
+	uint8_t newValue = *pos & ~(1 << (row % PAGE_LEN));
+	if (newValue != *pos) {
+		*pos = newValue;
+		mark_Dirty(row / PAGE_LEN, col);
+	}
 }
 
 /**
- * used to write data on the screen,
- * First turn on screen,
+ * combine the bits given in mask of one display array byte with value
+ * using the raster operation rop, the byte is marked dirty if it changes
  */
-void write_On_Screen(uint8_t page, uint8_t col_Address, uint8_t data) {
-	turn_On_Screen();
-	display_ON_OFF_Reg();
+static void rop_Byte(int page, int col, uint8_t value, uint8_t mask, int rop) {
+	uint8_t oldValue = display[page][col];
+	uint8_t newValue;
+	value &= mask;
+	switch (rop) {
+	case ROP_OR:
+		newValue = oldValue | value;
+		break;
+	case ROP_XOR:
+		newValue = oldValue ^ value;
+		break;
+	case ROP_AND_NOT:
+		newValue = oldValue & ~value;
+		break;
+	default:
+		newValue = (oldValue & ~mask) | value;
+		break;
+	}
+	if (newValue != oldValue) {
+		display[page][col] = newValue;
+		mark_Dirty(page, col);
+	}
+}
 
-	if (col_Address < MAX_COLS_LCD) {
-		set_Left_Side_Screen();
+/**
+ * combine 1 to 4 columns of a page with mask using rop, a fill sets
+ * all pixels of the mask so ROP_COPY is the same as ROP_OR
+ */
+static inline uint32_t rop_Fill(uint32_t value, uint32_t mask, int rop) {
+	switch (rop) {
+	case ROP_XOR:
+		return value ^ mask;
+	case ROP_AND_NOT:
+		return value & ~mask;
+	default:
+		return value | mask;
+	}
+}
+
+/**
+ * Fill the columns fromCol to toCol - 1 of one display array page with
+ * the rows in mask. The columns before the first word boundary and after
+ * the last full word are combined one byte at a time, all columns in
+ * between 4 at a time with one 32 bit load and store.
+ * Only the changed columns are marked dirty
+ */
+static void fill_Page_Span(int page, int fromCol, int toCol, uint8_t mask,
+		int rop) {
+	uint8_t *line = display[page];
+	uint32_t wideMask = mask * 0x01010101u;
+	int firstChanged = TOTAL_COLS;
+	int lastChanged = -1;
+	int col = fromCol;
+	int wordEnd = toCol & ~3;
+
+	for (; col < toCol && (col & 3) != 0; col++) {
+		uint8_t newValue = rop_Fill(line[col], mask, rop);
+		if (newValue != line[col]) {
+			line[col] = newValue;
+			firstChanged = firstChanged < col ? firstChanged : col;
+			lastChanged = col;
+		}
+	}
+	for (; col < wordEnd; col += 4) {
+		lcd_word_t *word = (lcd_word_t *) &line[col];
+		uint32_t newValue = rop_Fill(*word, wideMask, rop);
+		if (newValue != *word) {
+			*word = newValue;
+			firstChanged = firstChanged < col ? firstChanged : col;
+			lastChanged = col + 3;
+		}
+	}
+	for (; col < toCol; col++) {
+		uint8_t newValue = rop_Fill(line[col], mask, rop);
+		if (newValue != line[col]) {
+			line[col] = newValue;
+			firstChanged = firstChanged < col ? firstChanged : col;
+			lastChanged = col;
+		}
+	}
+
+	if (lastChanged >= 0) {
+		mark_Dirty(page, firstChanged);
+		mark_Dirty(page, lastChanged);
+	}
+}
+
+/**
+ * Fill a rectangle of the display array, top left corner at column x and row y.
+ * ROP_OR (or ROP_COPY) sets, ROP_AND_NOT clears and ROP_XOR inverts the pixels.
+ * The rectangle is clipped at the screen edges, every page it covers is
+ * changed with one row mask, so a vertical line costs one masked byte per page
+ * and a horizontal line or a fill is written 4 columns at a time
+ */
+void fill_Rect(int x, int y, int width, int height, int rop) {
+	int toX = x + width;
+	int toY = y + height;
+	x = x < 0 ? 0 : x;
+	y = y < 0 ? 0 : y;
+	toX = toX > TOTAL_COLS ? TOTAL_COLS : toX;
+	toY = toY > TOTAL_ROWS ? TOTAL_ROWS : toY;
+	if (x >= toX || y >= toY) {
+		return;
+	}
+
+	for (int page = y / PAGE_LEN; page <= (toY - 1) / PAGE_LEN; page++) {
+		// rows of the rectangle inside this page
+		int top = y - page * PAGE_LEN;
+		int bottom = toY - page * PAGE_LEN;
+		top = top < 0 ? 0 : top;
+		bottom = bottom > PAGE_LEN ? PAGE_LEN : bottom;
+		uint8_t mask = (0xFF >> (PAGE_LEN - (bottom - top))) << top;
+		fill_Page_Span(page, x, toX, mask, rop);
+	}
+}
+
+/**
+ * invert all pixels of the display array
+ */
+void invert_DisplayArr() {
+	fill_Rect(0, 0, TOTAL_COLS, TOTAL_ROWS, ROP_XOR);
+}
+
+/**
+ * Draw a sprite to the display array, top left corner at column x and row y.
+ * rop decides how the sprite is combined with the display array:
+ * ROP_COPY replaces the pixels, ROP_OR sets, ROP_AND_NOT clears the set pixels
+ * of the sprite and ROP_XOR toggles them, so drawing the same sprite twice
+ * with ROP_XOR removes it again.
+ * Every sprite byte is shifted to the row inside the page and combined with
+ * the two display pages it covers, the row masks of every sprite page are
+ * calculated once per page. The sprite is clipped at all four screen edges
+ */
+void blit(const struct bitmap *sprite, int x, int y, int rop) {
+	int spritePages = (sprite->height + PAGE_LEN - 1) / PAGE_LEN;
+	int shift = y & (PAGE_LEN - 1);
+	int firstPage = y >> 3;
+
+	// visible columns of the sprite
+	int fromX = x < 0 ? -x : 0;
+	int toX = sprite->width;
+	if (x + toX > TOTAL_COLS) {
+		toX = TOTAL_COLS - x;
+	}
+
+	for (int p = 0; p < spritePages; p++) {
+		// rows of this sprite page which belong to the sprite
+		int rowsLeft = sprite->height - p * PAGE_LEN;
+		uint8_t rowMask = rowsLeft >= PAGE_LEN ? 0xFF : (1 << rowsLeft) - 1;
+		uint16_t mask = rowMask << shift;
+		int upper = firstPage + p;
+		int lower = upper + 1;
+		int upperOn = upper >= 0 && upper < TOTAL_PAGES;
+		int lowerOn = lower >= 0 && lower < TOTAL_PAGES && (mask >> 8) != 0;
+		const uint8_t *src = &sprite->data[p * sprite->width];
+
+		for (int i = fromX; i < toX; i++) {
+			uint16_t value = src[i] << shift;
+			if (upperOn) {
+				rop_Byte(upper, x + i, value, mask, rop);
+			}
+			if (lowerOn) {
+				rop_Byte(lower, x + i, value >> 8, mask >> 8, rop);
+			}
+		}
+	}
+}
+
+#if LCD_GRAYSCALE
+/**
+ * Fill a rectangle of the gray planes with a gray level from 0 to 3,
+ * every plane is set or cleared where its bit of the level is 1 or 0
+ */
+void gray_Fill_Rect(int x, int y, int width, int height, int level) {
+	int oldLayer = drawLayer;
+	select_Layer(LAYER_GRAY_LOW);
+	fill_Rect(x, y, width, height, (level & 1) ? ROP_OR : ROP_AND_NOT);
+	select_Layer(LAYER_GRAY_HIGH);
+	fill_Rect(x, y, width, height, (level & 2) ? ROP_OR : ROP_AND_NOT);
+	select_Layer(oldLayer);
+}
+
+/**
+ * Draw the set pixels of a sprite into the gray planes with a gray level,
+ * the pixels around the sprite keep their level
+ */
+void gray_Blit(const struct bitmap *sprite, int x, int y, int level) {
+	int oldLayer = drawLayer;
+	select_Layer(LAYER_GRAY_LOW);
+	blit(sprite, x, y, (level & 1) ? ROP_OR : ROP_AND_NOT);
+	select_Layer(LAYER_GRAY_HIGH);
+	blit(sprite, x, y, (level & 2) ? ROP_OR : ROP_AND_NOT);
+	select_Layer(oldLayer);
+}
+#endif
+
+/**
+ * Add an object to the scene with the top left corner of its sprite
+ * at column x and row y, it is drawn by the next scene_Update.
+ * Return the id of the object or -1 if the scene is full
+ */
+int scene_Add(const struct bitmap *sprite, int x, int y) {
+	if (sceneCount >= MAX_SCENE_OBJECTS) {
+		return -1;
+	}
+	struct scene_object *object = &sceneObjects[sceneCount];
+	object->sprite = sprite;
+	object->x = x;
+	object->y = y;
+	object->visible = 1;
+	object->drawn = 0;
+	return sceneCount++;
+}
+
+/**
+ * move an object, the top left corner of its sprite to column x and row y
+ */
+void scene_Move(int id, int x, int y) {
+	sceneObjects[id].x = x;
+	sceneObjects[id].y = y;
+}
+
+/**
+ * show (visible 1) or hide an object
+ */
+void scene_Show(int id, int visible) {
+	sceneObjects[id].visible = visible;
+}
+
+/**
+ * byte of one display page and column covered by a sprite
+ * with its top left corner at column x and row y
+ */
+static uint8_t sprite_Page_Byte(const struct bitmap *sprite, int x, int y,
+		int page, int col) {
+	int spriteCol = col - x;
+	int top = page * PAGE_LEN - y;
+	if (spriteCol < 0 || spriteCol >= sprite->width || top >= sprite->height
+			|| top <= -PAGE_LEN) {
+		return 0;
+	}
+	int spritePages = (sprite->height + PAGE_LEN - 1) / PAGE_LEN;
+	const uint8_t *src = &sprite->data[spriteCol];
+	uint16_t value;
+	if (top < 0) {
+		value = src[0] << -top;
 	} else {
-		set_Right_Side_Screen();
+		int p = top / PAGE_LEN;
+		value = src[p * sprite->width] >> (top % PAGE_LEN);
+		if (p + 1 < spritePages) {
+			value |= src[(p + 1) * sprite->width] << (PAGE_LEN - top % PAGE_LEN);
+		}
 	}
-	toggle_Enable_Lcd();
+	// rows below the sprite
+	int rowsLeft = sprite->height - top;
+	if (rowsLeft < PAGE_LEN) {
+		value &= (1 << rowsLeft) - 1;
+	}
+	return value;
+}
 
-	// select page
-	set_Page(page);
-	toggle_Enable_Lcd();
+/**
+ * Compose a damaged rectangle of the dynamic layer from the visible objects,
+ * every byte is calculated once from all objects covering it and only
+ * written (and marked dirty) when it changes
+ */
+static void scene_Compose(int fromX, int fromY, int toX, int toY) {
+	fromX = fromX < 0 ? 0 : fromX;
+	fromY = fromY < 0 ? 0 : fromY;
+	toX = toX > TOTAL_COLS ? TOTAL_COLS : toX;
+	toY = toY > TOTAL_ROWS ? TOTAL_ROWS : toY;
+	if (fromX >= toX || fromY >= toY) {
+		return;
+	}
 
-	// select Col
-	set_ColAddress(col_Address);
-	toggle_Enable_Lcd();
+	for (int page = fromY / PAGE_LEN; page <= (toY - 1) / PAGE_LEN; page++) {
+		int top = fromY - page * PAGE_LEN;
+		int bottom = toY - page * PAGE_LEN;
+		top = top < 0 ? 0 : top;
+		bottom = bottom > PAGE_LEN ? PAGE_LEN : bottom;
+		uint8_t mask = (0xFF >> (PAGE_LEN - (bottom - top))) << top;
 
-	// Send Data
-	send_Data(data);
-	set_Control_Buss_To_Write();
-	toggle_Enable_Lcd();
+		for (int col = fromX; col < toX; col++) {
+			uint8_t value = 0;
+			for (int i = 0; i < sceneCount; i++) {
+				struct scene_object *object = &sceneObjects[i];
+				if (object->visible) {
+					value |= sprite_Page_Byte(object->sprite, object->x,
+							object->y, page, col);
+				}
+			}
+			rop_Byte(page, col, value, mask, ROP_COPY);
+		}
+	}
 }
 
 /**
- * Set page on which data is to be written
+ * Draw the changes of the scene into the dynamic layer, called once per frame
+ * before present. For every moved, shown or hidden object the bounding box
+ * it was drawn at and the one it is drawn at now are the damaged region,
+ * boxes which overlap or touch are joined. The damaged region is composed
+ * from all visible objects, so a moved object is not erased and drawn again
+ * and objects crossing each other stay intact.
+ * The scene owns the pixels under its objects, other drawings of the
+ * dynamic layer in a damaged region are replaced
  */
-void set_Page(uint8_t num) {
-	GPIOC->ODR = (GPIOC->ODR & 0xFF00) | (PAGE_SEL_MASK | num);
+void scene_Update() {
+	int oldLayer = drawLayer;
+	select_Layer(LAYER_DYNAMIC);
+
+	for (int i = 0; i < sceneCount; i++) {
+		struct scene_object *object = &sceneObjects[i];
+		if (object->drawn == object->visible
+				&& (!object->visible
+						|| (object->drawnX == object->x
+								&& object->drawnY == object->y))) {
+			continue;
+		}
+		int width = object->sprite->width;
+		int height = object->sprite->height;
+		int oldX = object->drawnX;
+		int oldY = object->drawnY;
+		int wasDrawn = object->drawn;
+
+		// the new state first, so composing sees the object where it is now
+		object->drawnX = object->x;
+		object->drawnY = object->y;
+		object->drawn = object->visible;
+
+		if (wasDrawn && object->visible && oldX <= object->x + width
+				&& object->x <= oldX + width && oldY <= object->y + height
+				&& object->y <= oldY + height) {
+			int fromX = oldX < object->x ? oldX : object->x;
+			int fromY = oldY < object->y ? oldY : object->y;
+			int toX = (oldX > object->x ? oldX : object->x) + width;
+			int toY = (oldY > object->y ? oldY : object->y) + height;
+			scene_Compose(fromX, fromY, toX, toY);
+			continue;
+		}
+		if (wasDrawn) {
+			scene_Compose(oldX, oldY, oldX + width, oldY + height);
+		}
+		if (object->visible) {
+			scene_Compose(object->x, object->y, object->x + width,
+					object->y + height);
+		}
+	}
+
+	select_Layer(oldLayer);
 }
 
 /**
- * Set col address in which data is written
+ * used to write data on the screen,
+ * First turn on screen,
  */
-void set_ColAddress(uint8_t address) {
-	GPIOC->ODR = (GPIOC->ODR & 0xFF00) | (COL_SEL_MASK | address);
+void write_On_Screen(uint8_t page, uint8_t col_Address, uint8_t data) {
+	PERF_BEGIN();
+	write_Burst_On_Screen(page, col_Address, &data, 1);
+	PERF_END(PERF_WRITE_ON_SCREEN);
 }
 
 /**
- * send the data which is to be written
+ * Select the half of the screen which has the given column,
+ * turn it on and set page and column address
+ * the following data writes start at this position
  */
-void send_Data(uint8_t data) {
-	GPIOC->ODR = (GPIOC->ODR & 0xFF00) | data;
+void set_Lcd_Address(uint8_t page, uint8_t col_Address) {
+	busChips = col_Address < MAX_COLS_LCD ? LCD_CS_LEFT : LCD_CS_RIGHT;
+	lcd_Bus_Write(TURN_ON_SCREEEN, 0, busChips);
+	lcd_Bus_Write(PAGE_SEL_MASK | page, 0, busChips);
+	lcd_Bus_Write(COL_SEL_MASK | (col_Address % MAX_COLS_LCD), 0, busChips);
 }
 
 /**
- * Write the given number to the display
- * toShift is used to shift the column
+ * Send len data bytes to the address set before with set_Lcd_Address,
+ * the lcd increments the column after every byte so only
+ * one enable strobe is needed per byte.
+ * The bytes must not cross the border between the two halves
  */
-void writeNumber(int number, int toShift) {
-	if (number == 0) {
-		writeZero(toShift);
-	} else if (number == 1) {
-		writeOne(toShift);
-	} else if (number == 2) {
-		writeTwo(toShift);
-	} else if (number == 3) {
-		WriteThree(toShift);
-	} else if (number == 4) {
-		writeFour(toShift);
-	} else if (number == 5) {
-		writeFive(toShift);
-	} else if (number == 6) {
-		writeSix(toShift);
-	} else if (number == 7) {
-		writeSeven(toShift);
-	} else if (number == 8) {
-		wirteEight(toShift);
-	} else if (number == 9) {
-		writeNine(toShift);
+void stream_Data(const uint8_t *data, int len) {
+	for (int i = 0; i < len; i++) {
+		lcd_Bus_Write(data[i], 1, busChips);
 	}
+	totalLcdWrites += len;
 }
 
 /**
- * Write zero to display, toShift is for shifting the column
+ * write len bytes starting at the given page and column,
+ * the page and column are only set once for every half of the screen
  */
-void writeZero(int toShiftCol) {
-	draw_Vert_Line(30, 20 + toShiftCol, 20, 1);
-	draw_Horiz_Line(30, 10 + toShiftCol, 10);
-	draw_Horiz_Line(50, 10 + toShiftCol, 10);
-	draw_Vert_Line(30, 10 + toShiftCol, 20, 1);
+void write_Burst_On_Screen(uint8_t page, uint8_t col_Address,
+		const uint8_t *data, int len) {
+	PERF_BEGIN();
+	while (len > 0) {
+		// bytes left until the end of the current half
+		int toSend = MAX_COLS_LCD - (col_Address % MAX_COLS_LCD);
+		if (toSend > len) {
+			toSend = len;
+		}
+		set_Lcd_Address(page, col_Address);
+		stream_Data(data, toSend);
+		col_Address += toSend;
+		data += toSend;
+		len -= toSend;
+	}
+	PERF_END(PERF_WRITE_BURST);
 }
 
 /**
- * Write one to display, toShift is for shifting the column
+ * Set page on which data is to be written
  */
-void writeOne(int toShiftCol) {
-	draw_Vert_Line(30, 20 + toShiftCol, 20, 1);
+void set_Page(uint8_t num) {
+	send_Data(PAGE_SEL_MASK | num);
 }
 
 /**
- * Write two to display, toShift is for shifting the column
+ * Set col address in which data is written
  */
-void writeTwo(int toShiftCol) {
-	wirteEight(toShiftCol);
-	draw_Vert_Line(40, 20 + toShiftCol, 10, 0);
-	draw_Vert_Line(30, 10 + toShiftCol, 10, 0);
+void set_ColAddress(uint8_t address) {
+	send_Data(COL_SEL_MASK | address);
 }
 
 /**
- * Write Three to display, toShift is for shifting the column
+ * send the data which is to be written
  */
-void WriteThree(int toShiftCol) {
-	wirteEight(toShiftCol);
-	draw_Vert_Line(30, 10 + toShiftCol, 20, 0);
+void send_Data(uint8_t data) {
+	LCD_BUS_STORE(data | ((uint32_t) (uint8_t) ~data << 16));
 }
 
 /**
- * Write Four to display, toShift is for shifting the column
+ * Score digits, 11 x 21 pixels, three pages per glyph
+ * one byte per column and page, bit 0 is the top row
+ */
+static const uint8_t scoreFontData[] = {
+	// '0'
+	0xFF, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF,
+	0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
+	0x1F, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x0F,
+	// '1'
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F,
+	// '2'
+	0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF,
+	0xFC, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x03,
+	0x1F, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00,
+	// '3'
+	0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF,
+	0x00, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0xFF,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x0F,
+	// '4'
+	0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
+	0x07, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0xFF,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F,
+	// '5'
+	0xFF, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,
+	0x03, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0xFC,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x0F,
+	// '6'
+	0xFF, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,
+	0xFF, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0xFC,
+	0x1F, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x0F,
+	// '7'
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F,
+	// '8'
+	0xFF, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF,
+	0xFF, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0xFF,
+	0x1F, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x0F,
+	// '9'
+	0xFF, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF,
+	0x03, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0xFF,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x0F,
+};
+
+const struct font scoreFont = { 11, 21, 30, '0', '9', scoreFontData };
+
+/**
+ * Small text font, 5 x 7 pixels, one page per glyph,
+ * space to 'Z', lower case letters are drawn as upper case
+ */
+static const uint8_t smallFontData[] = {
+	0x00, 0x00, 0x00, 0x00, 0x00, // ' '
+	0x00, 0x00, 0x5F, 0x00, 0x00, // '!'
+	0x00, 0x07, 0x00, 0x07, 0x00, // '"'
+	0x14, 0x7F, 0x14, 0x7F, 0x14, // '#'
+	0x24, 0x2A, 0x7F, 0x2A, 0x12, // '$'
+	0x23, 0x13, 0x08, 0x64, 0x62, // '%'
+	0x36, 0x49, 0x56, 0x20, 0x50, // '&'
+	0x00, 0x05, 0x03, 0x00, 0x00, // '''
+	0x00, 0x1C, 0x22, 0x41, 0x00, // '('
+	0x00, 0x41, 0x22, 0x1C, 0x00, // ')'
+	0x2A, 0x1C, 0x7F, 0x1C, 0x2A, // '*'
+	0x08, 0x08, 0x3E, 0x08, 0x08, // '+'
+	0x00, 0x50, 0x30, 0x00, 0x00, // ','
+	0x08, 0x08, 0x08, 0x08, 0x08, // '-'
+	0x00, 0x60, 0x60, 0x00, 0x00, // '.'
+	0x20, 0x10, 0x08, 0x04, 0x02, // '/'
+	0x3E, 0x51, 0x49, 0x45, 0x3E, // '0'
+	0x00, 0x42, 0x7F, 0x40, 0x00, // '1'
+	0x42, 0x61, 0x51, 0x49, 0x46, // '2'
+	0x21, 0x41, 0x45, 0x4B, 0x31, // '3'
+	0x18, 0x14, 0x12, 0x7F, 0x10, // '4'
+	0x27, 0x45, 0x45, 0x45, 0x39, // '5'
+	0x3C, 0x4A, 0x49, 0x49, 0x30, // '6'
+	0x01, 0x71, 0x09, 0x05, 0x03, // '7'
+	0x36, 0x49, 0x49, 0x49, 0x36, // '8'
+	0x06, 0x49, 0x49, 0x29, 0x1E, // '9'
+	0x00, 0x36, 0x36, 0x00, 0x00, // ':'
+	0x00, 0x56, 0x36, 0x00, 0x00, // ';'
+	0x08, 0x14, 0x22, 0x41, 0x00, // '<'
+	0x14, 0x14, 0x14, 0x14, 0x14, // '='
+	0x00, 0x41, 0x22, 0x14, 0x08, // '>'
+	0x02, 0x01, 0x51, 0x09, 0x06, // '?'
+	0x32, 0x49, 0x79, 0x41, 0x3E, // '@'
+	0x7E, 0x11, 0x11, 0x11, 0x7E, // 'A'
+	0x7F, 0x49, 0x49, 0x49, 0x36, // 'B'
+	0x3E, 0x41, 0x41, 0x41, 0x22, // 'C'
+	0x7F, 0x41, 0x41, 0x22, 0x1C, // 'D'
+	0x7F, 0x49, 0x49, 0x49, 0x41, // 'E'
+	0x7F, 0x09, 0x09, 0x09, 0x01, // 'F'
+	0x3E, 0x41, 0x49, 0x49, 0x7A, // 'G'
+	0x7F, 0x08, 0x08, 0x08, 0x7F, // 'H'
+	0x00, 0x41, 0x7F, 0x41, 0x00, // 'I'
+	0x20, 0x40, 0x41, 0x3F, 0x01, // 'J'
+	0x7F, 0x08, 0x14, 0x22, 0x41, // 'K'
+	0x7F, 0x40, 0x40, 0x40, 0x40, // 'L'
+	0x7F, 0x02, 0x0C, 0x02, 0x7F, // 'M'
+	0x7F, 0x04, 0x08, 0x10, 0x7F, // 'N'
+	0x3E, 0x41, 0x41, 0x41, 0x3E, // 'O'
+	0x7F, 0x09, 0x09, 0x09, 0x06, // 'P'
+	0x3E, 0x41, 0x51, 0x21, 0x5E, // 'Q'
+	0x7F, 0x09, 0x19, 0x29, 0x46, // 'R'
+	0x46, 0x49, 0x49, 0x49, 0x31, // 'S'
+	0x01, 0x01, 0x7F, 0x01, 0x01, // 'T'
+	0x3F, 0x40, 0x40, 0x40, 0x3F, // 'U'
+	0x1F, 0x20, 0x40, 0x20, 0x1F, // 'V'
+	0x3F, 0x40, 0x38, 0x40, 0x3F, // 'W'
+	0x63, 0x14, 0x08, 0x14, 0x63, // 'X'
+	0x07, 0x08, 0x70, 0x08, 0x07, // 'Y'
+	0x61, 0x51, 0x49, 0x45, 0x43, // 'Z'
+};
+
+const struct font smallFont = { 5, 7, 6, ' ', 'Z', smallFontData };
+
+/**
+ * Draw one glyph of the font with its top left corner at column x and row y,
+ * the whole glyph box is copied so it replaces what was drawn there before.
+ * Characters the font does not have are skipped
  */
-void writeFour(int toShiftCol) {
-	draw_Vert_Line(30, 20 + toShiftCol, 20, 1);
-	draw_Horiz_Line(40, 10 + toShiftCol, 10);
-	draw_Vert_Line(30, 10 + toShiftCol, 10, 1);
+static void draw_Glyph(const struct font *font, char c, int x, int y) {
+	if (c >= 'a' && c <= 'z' && font->last < 'a') {
+		c = c - 'a' + 'A';
+	}
+	if (c < font->first || c > font->last) {
+		return;
+	}
+	int glyphBytes = font->width * ((font->height + PAGE_LEN - 1) / PAGE_LEN);
+	struct bitmap glyph = { font->width, font->height,
+			&font->data[(c - font->first) * glyphBytes] };
+	blit(&glyph, x, y, ROP_COPY);
 }
 
 /**
- * Write Five to display, toShift is for shifting the column
+ * Draw a string, the first glyph has its top left corner at column x and row y,
+ * return the column after the last glyph
  */
-void writeFive(int toShiftCol) {
-	wirteEight(toShiftCol);
-	draw_Vert_Line(30, 20 + toShiftCol, 10, 0);
-	draw_Vert_Line(40, 10 + toShiftCol, 10, 0);
+int drawText(const char *text, int x, int y, const struct font *font) {
+	while (*text != '\0') {
+		draw_Glyph(font, *text, x, y);
+		x += font->advance;
+		text++;
+	}
+	return x;
 }
 
 /**
- * Write Six to display, toShift is for shifting the column
+ * convert number to decimal text, at least minDigits digits with leading zeros,
+ * text must hold MAX_NUMBER_DIGITS + 1 characters
  */
-void writeSix(int toShiftCol) {
-	wirteEight(toShiftCol);
-	draw_Vert_Line(30, 20 + toShiftCol, 10, 0);
+static void number_To_Text(uint32_t number, int minDigits, char *text) {
+	char reversed[MAX_NUMBER_DIGITS];
+	int digits = 0;
+	do {
+		reversed[digits++] = '0' + number % 10;
+		number /= 10;
+	} while (number != 0);
+	while (digits < minDigits && digits < MAX_NUMBER_DIGITS) {
+		reversed[digits++] = '0';
+	}
+	for (int i = 0; i < digits; i++) {
+		text[i] = reversed[digits - 1 - i];
+	}
+	text[digits] = '\0';
 }
 
 /**
- * Write Seven to display, toShift is for shifting the column
+ * Draw a number with any number of digits, at least minDigits digits
+ * with leading zeros, return the column after the last digit
  */
-void writeSeven(int toShiftCol) {
-	draw_Vert_Line(30, 20 + toShiftCol, 20, 1);
-	draw_Horiz_Line(30, 10 + toShiftCol, 10);
+int drawNumber(uint32_t number, int minDigits, int x, int y,
+		const struct font *font) {
+	char text[MAX_NUMBER_DIGITS + 1];
+	number_To_Text(number, minDigits, text);
+	return drawText(text, x, y, font);
 }
 
 /**
- * Write Eight to display, toShift is for shifting the column
+ * width in pixels of a number drawn with drawNumber
  */
-void wirteEight(int toShiftCol) {
-	writeZero(toShiftCol);
-	draw_Horiz_Line(40, 10 + toShiftCol, 10);
+int get_Number_Width(uint32_t number, int minDigits, const struct font *font) {
+	char text[MAX_NUMBER_DIGITS + 1];
+	int digits = 0;
+	number_To_Text(number, minDigits, text);
+	while (text[digits] != '\0') {
+		digits++;
+	}
+	return (digits - 1) * font->advance + font->width;
 }
 
 /**
- * Write Nine to display, toShift is for shifting the column
+ * Write the given digit in the score font, at the place
+ * the line drawn digits had, toShift is used to shift the column
  */
-void writeNine(int toShiftCol) {
-	wirteEight(toShiftCol);
-	draw_Vert_Line(40, 10 + toShiftCol, 10, 0);
+void writeNumber(int number, int toShift) {
+	if (number >= 0 && number <= 9) {
+		draw_Glyph(&scoreFont, '0' + number, SCORE_DIGIT_COL + toShift,
+				SCORE_ROW);
+	}
 }
 
+/**
+ * Welcome message, 128 x 19 pixels
+ * one byte per column and page, bit 0 is the top row
+ */
+static const uint8_t welcomeData[] = {
+		0x00, 0x00, 0x00, 0x03, 0xC3, 0xFC, 0xBC, 0x00, 0x00, 0x00, 0x00, 0xBC,
+		0xFE, 0x43, 0xC3, 0xFC, 0xBC, 0x00, 0x00, 0x00, 0x00, 0x3C, 0xFC, 0xC3,
+		0x03, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+		0x03, 0x03, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0xBC, 0xFC, 0x40, 0x02, 0x02, 0x03, 0x03, 0x03, 0x03,
+		0x03, 0x02, 0x00, 0x00, 0x00, 0xBC, 0xFC, 0x40, 0x02, 0x02, 0x03, 0x03,
+		0x03, 0x03, 0x03, 0x03, 0x02, 0x42, 0xFC, 0xBC, 0x00, 0x00, 0x00, 0x00,
+		0xFF, 0xFF, 0x03, 0x43, 0xFC, 0xBC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0xBC, 0xFC, 0x42, 0x03, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF,
+		0xFF, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x0F, 0x7F, 0xF8, 0x80, 0x80, 0xF8, 0x7F, 0x07, 0x00, 0x00, 0x07,
+		0x7F, 0xF8, 0xC0, 0x80, 0xF0, 0x7F, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0xFF, 0xFF, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x00, 0x00, 0x00,
+		0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F,
+		0xFF, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00,
+		0x00, 0x3F, 0xFF, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x80, 0xC0, 0xFF, 0x3F, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00,
+		0x07, 0x0F, 0x3E, 0xF8, 0xE0, 0x00, 0xC0, 0xF8, 0x3E, 0x0F, 0x07, 0x00,
+		0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x06, 0x06, 0x06,
+		0x06, 0x06, 0x06, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07,
+		0x07, 0x07, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x07, 0x07,
+		0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x07, 0x06, 0x06,
+		0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x00, 0x00, 0x00, 0x07, 0x07, 0x06,
+		0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x00, 0x00, 0x00, 0x01, 0x03, 0x07,
+		0x06, 0x06, 0x06, 0x06, 0x07, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x03,
+		0x03, 0x07, 0x06, 0x06, 0x06, 0x06, 0x06, 0x03, 0x03, 0x01, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x07, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+		0x07, 0x07, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x07, 0x00,
+		0x00, 0x00, 0x00, 0x07, 0x07, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06,
+		0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static const struct bitmap welcomeBitmap = { 128, 19, welcomeData };
+
+/**
+ * Game over message, 128 x 13 pixels
+ * one byte per column and page, bit 0 is the top row
+ */
+static const uint8_t gameOverData[] = {
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFC,
+		0x06, 0x02, 0x01, 0x41, 0x41, 0x41, 0x41, 0xC2, 0x00, 0x00, 0x00, 0x00,
+		0x80, 0xF0, 0x1E, 0x03, 0x0F, 0x7C, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0xFF, 0x03, 0x0F, 0x78, 0xE0, 0x00, 0x00, 0x00, 0xC0, 0x78, 0x0E, 0x03,
+		0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x41, 0x41, 0x41, 0x41, 0x41, 0x01,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFC, 0x06, 0x03, 0x01,
+		0x01, 0x01, 0x01, 0x02, 0xFE, 0xF8, 0x00, 0x01, 0x0F, 0x7C, 0xE0, 0x00,
+		0x00, 0x00, 0xC0, 0x78, 0x0F, 0x01, 0x00, 0x00, 0xFF, 0x41, 0x41, 0x41,
+		0x41, 0x41, 0x01, 0x00, 0x00, 0x00, 0xFF, 0x41, 0x41, 0x41, 0xC1, 0xA3,
+		0x3E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x0C, 0x08, 0x10, 0x10,
+		0x10, 0x10, 0x10, 0x0F, 0x00, 0x00, 0x10, 0x1C, 0x07, 0x03, 0x02, 0x02,
+		0x02, 0x02, 0x03, 0x1F, 0x18, 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00,
+		0x03, 0x0F, 0x1C, 0x0F, 0x01, 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00,
+		0x00, 0x1F, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x03, 0x07, 0x08, 0x10, 0x10, 0x10, 0x10, 0x18, 0x08,
+		0x07, 0x03, 0x00, 0x00, 0x00, 0x00, 0x03, 0x1F, 0x18, 0x1E, 0x03, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x1F, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00,
+		0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x03, 0x1E, 0x18, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00
+};
+
+static const struct bitmap gameOverBitmap = { 128, 13, gameOverData };
+
 /**
  * Write Welcome on screen
  */
 void writeWelcomeToArray() {
-	uint8_t welcome[19][128] = { { 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
-			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-			0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-			1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0,
-			1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, {
-			0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-			1, 1, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 1, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1,
-			1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
-			1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 1, 1, 0,
-			0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0,
-			0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1,
-			1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1,
-			1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1,
-			1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0,
-			0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0,
-			0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0,
-			0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0,
-			0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 1, 1, 0, 0,
-			0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0,
-			1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0 }, { 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0,
-			0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 1,
-			0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 1, 0, 0, 0, 0, 1, 1,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0,
-			0, 0, 1, 1, 1, 0, 0, 0, 0, 1, 1, 0, 1, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0,
-			0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0,
-			0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0,
-			0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 1, 1, 0, 0, 0,
-			0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
-			1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1,
-			1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0 }, { 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0,
-			0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0,
-			1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0,
-			0, 1, 1, 1, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 1,
-			1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0,
-			0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0,
-			0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0,
-			0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 1, 0, 0, 0, 0,
-			0, 1, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0	// 28
-			}, { 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0,
-					1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-					1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-					0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0,
-					0, 0, 0, 1, 1, 0, 0, 0, 1, 1, 1, 0, 0, 0, 1, 1, 1, 0, 0, 0,
-					1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-					0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1,
-					0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0,
-					0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1,
-					1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0,
-					0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1,
-					0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0,
-					0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0,
-					0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0,
-					0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
-					0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-					0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0,
-					0, 1, 1, 0, 0, 0, 0, 1, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1,
-					0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-					0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0,
-					0, 0, 1, 1, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0,
-					0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
-					0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0,
-					0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0,
-					1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0,
-					0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0,
-					0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0,
-					0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0,
-					0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0,
-					0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 1,
-					1, 0, 0, 0, 0, 0, 1, 1, 0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0,
-					0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-					0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0,
-					0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0,
-					0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1,
-					0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 1,
-					1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0,
-					0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0,
-					0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0,
-					1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
-					0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 1, 1, 1, 1, 1,
-					1, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
-					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0,
-					0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0,
-					1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-					0 }, { 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1,
-					1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-					0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 1, 1,
-					1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0,
-					0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0,
-					0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
-					0, 0, 0, 0, 0, 0, 0, 0, 0, 0 } };
-
-	for (int i = 0; i < 19; i++) {
-		for (int j = 0; j < 128; j++) {
-			display[i + 10][j] = welcome[i][j];
-		}
-	}
+	blit(&welcomeBitmap, 0, BANNER_START_ROW, ROP_COPY);
 }
 
 /**
  * Write game over message on the screen
  */
 void writeGameOver() {
-	uint8_t gameOver[13][128] = { { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
-			1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1,
-			1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0,
-			0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 1, 1, 1, 1,
-			1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0,
-			0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0,
-			1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,
-			1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 1, 0,
-			0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0, 1,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1,
-			0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 1,
-			1, 0, 0, 0, 0, 0, 1, 1, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0,
-			0, 0, 1, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
-			1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 1, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0,
-			0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0,
-			0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0,
-			0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 1, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1,
-			0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 1, 1,
-			1, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1,
-			1, 0, 0, 0, 1, 1, 0, 0, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0,
-			0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 1, 1, 0, 0, 0,
-			1, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1,
-			1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0,
-			1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0,
-			0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0,
-			0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 1, 1, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0,
-			0, 0, 0, 1, 1, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0,
-			0, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1,
-			1, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1, 0, 1, 1,
-			0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 1, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0,
-			0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 1,
-			0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,
-			0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0,
-			0, 0, 1, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0,
-			0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
-			0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1,
-			0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0,
-			1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0,
-			0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 1, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 } };
-	for (int i = 0; i < 13; i++) {
-		for (int j = 0; j < 128; j++) {
-			display[i + 10][j] = gameOver[i][j];
-		}
-	}
+	blit(&gameOverBitmap, 0, BANNER_START_ROW, ROP_COPY);
 }
+
@@ -1,11 +1,23 @@
+#include <stdio.h>
 #include "app.h"
 #include "main.h"
 #include "timer.h"
 #include "mpu6050.h"
 #include "Dem128064B.h"
+#include "perf.h"
+#include "mirror.h"
 
 extern UART_HandleTypeDef huart2;
 
+/**
+ * a gray phase step sends up to 295 bus writes (about 3 ms with the fixed
+ * delays) every GRAY_PHASE_RATE ticks, only the sliced or the background
+ * refresh keep that out of the SysTick handler
+ */
+#if LCD_GRAYSCALE && !LCD_SLICED_REFRESH && !LCD_DMA_REFRESH
+#error "LCD_GRAYSCALE needs LCD_SLICED_REFRESH or LCD_DMA_REFRESH"
+#endif
+
 /**
  * Line Starting positions
  */
@@ -19,6 +31,57 @@ int lineColSlowMove = 127;
  */
 int score = 0;
 
+/**
+ * last byte received on uart 2 and the request for a perf dump,
+ * set when PERF_DUMP_CMD is received, handled in app_loop,
+ * MIRROR_TOGGLE_CMD turns the uart mirror on and off
+ */
+static uint8_t uartCommand;
+static volatile int perfDumpRequested = 0;
+
+/**
+ * moving lines, one pixel wide vertical bitmaps
+ */
+static const uint8_t upperLineData[] = { 0xFF, 0xFF, 0xFF, 0x3F };
+static const struct bitmap upperLineSprite = { 1, LENGTH_UPPER_LINE,
+		upperLineData };
+static const uint8_t lowerLineData[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+static const struct bitmap lowerLineSprite = { 1, LENGTH_OF_LOWER_LINE,
+		lowerLineData };
+
+/**
+ * set while app_loop draws the game over screen, the periodic refresh
+ * and gray phase leave the display to it meanwhile
+ */
+static volatile int drawPaused = 0;
+
+#if MPU_ACQ_MODE != MPU_ACQ_BLOCKING
+/**
+ * failed sensor reads already reported on the uart
+ */
+static uint32_t reportedReadErrors = 0;
+#endif
+
+/**
+ * scene objects of the ball and the two lines,
+ * moved by the timer functions and drawn once per frame by refresh
+ */
+static int ballObject;
+static int upperLineObject;
+static int lowerLineObject;
+
+#if LCD_GRAYSCALE
+/**
+ * positions of the ball in the last frames, newest first,
+ * and the position of the ball in the last frame
+ */
+static int trailCol[GRAY_TRAIL_LEN];
+static int trailRow[GRAY_TRAIL_LEN];
+static int trailLen = 0;
+static int lastBallCol;
+static int lastBallRow;
+#endif
+
 /**
  * initialization of the MPU Module, check if initialization is successful,
  * check if it is working,
@@ -27,6 +90,9 @@ int score = 0;
  * called periodically in timer_register
  */
 void app_init(void) {
+	// setup Lcd, starts the cycle counter which also times the sensor
+	setUp();
+
 	// Init MPU and error handling
 	if (mpu6050_init() != 1) {
 		HAL_UART_Transmit(&huart2, "Init Fails ...", 14, HAL_MAX_DELAY);
@@ -35,21 +101,57 @@ void app_init(void) {
 		HAL_UART_Transmit(&huart2, "NOT WORKING ...", 15, HAL_MAX_DELAY);
 	}
 
-	// setup Lcd
-	setUp();
-
 	// write welcome message when game is started...
+	// banners and the score are drawn into the static layer
+	select_Layer(LAYER_STATIC);
 	writeWelcomeToArray();
-	refresh();
+	refreshNow();
 	HAL_Delay(WELCOME_MESSAGE_DELAY);
 	init_DisplayArray();
 	HAL_Delay(100);
-	refresh();
+	refreshNow();
+	select_Layer(LAYER_DYNAMIC);
+
+	// the moving objects, drawn by the refresh
+	ballObject = scene_Add(&ballSprite, prevPos.prev_Col / 10 - 1,
+			prevPos.prev_Row / 10 - 1);
+	upperLineObject = scene_Add(&upperLineSprite, lineCol, START_OF_UPPER_LINE);
+	lowerLineObject = scene_Add(&lowerLineSprite, lineColSlowMove,
+			START_OF_LOWER_LINE);
+
+#if LCD_GRAYSCALE
+	// the dimmed band between the lanes
+	gray_Fill_Rect(0, GRAY_LANE_ROW, TOTAL_COLS, GRAY_LANE_HEIGHT,
+			GRAY_LANE_LEVEL);
+	lastBallCol = prevPos.prev_Col / 10 - 1;
+	lastBallRow = prevPos.prev_Row / 10 - 1;
+#endif
+
+	// listen for commands on the uart
+	HAL_UART_Receive_IT(&huart2, &uartCommand, 1);
+
+#if MPU_DATA_READY_INT
+	// the sensor starts the reads at its own rate
+	if (enableDataReady() != 1) {
+		HAL_UART_Transmit(&huart2, "Init Fails ...", 14, HAL_MAX_DELAY);
+	}
+#endif
 
 	// registring the functions to be called periodically
+#if MPU_FIFO_MODE
+	startFifo();
+	timer_register(getMpuData, MPU_FIFO_SERVICE_RATE);
+#elif !MPU_DATA_READY_INT
 	timer_register(getMpuData, SENSOR_REFRESH_RATE);
+#endif
 	timer_register(ballMovementWithSpeed, BALL_MOVEMENT_RATE);
-	timer_register(refresh, REFRESH_RATE);
+	timer_register(refreshTick, REFRESH_RATE);
+#if LCD_SLICED_REFRESH
+	timer_register(refreshSlice, REFRESH_SLICE_RATE);
+#endif
+#if LCD_GRAYSCALE
+	timer_register(grayPhase, GRAY_PHASE_RATE);
+#endif
 	timer_register(moveLine, MOVE_LINE_UPPER_RATE);
 	timer_register(slowMoveLine, MOVE_LINE_LOWER_RATE);
 }
@@ -60,9 +162,28 @@ void app_init(void) {
  * and calculated score, ball is set to starting position,
  */
 void app_loop(void) {
+#if MPU_ACQ_MODE != MPU_ACQ_BLOCKING
+	// the sample read in the background
+	if (processSample() == 1) {
+		printResult();
+	}
+	if (getReadErrors() != reportedReadErrors) {
+		reportedReadErrors = getReadErrors();
+		HAL_UART_Transmit(&huart2, "Reading Error ...", 17, HAL_MAX_DELAY);
+	}
+#endif
+	if (perfDumpRequested) {
+		perfDumpRequested = 0;
+		dumpPerf();
+	}
 	if (gameEnd == 1) {
-		// clear the screen 
-		init_DisplayArray();
+		// the timer refresh must not draw or present in between
+		drawPaused = 1;
+
+		// hide the ball and the lines
+		scene_Show(ballObject, 0);
+		scene_Show(upperLineObject, 0);
+		scene_Show(lowerLineObject, 0);
 
 		// refresh the screen, set the content of the 2d array to the LCD
 		refresh();
@@ -75,13 +196,43 @@ void app_loop(void) {
 		lineCol = START_LINE_COL_VALUE;
 		lineColSlowMove = START_LINE_COL_VALUE;
 
-		// set game over message
+#if LCD_GRAYSCALE
+		// no gray pixels on the game over screen
+		gray_Fill_Rect(0, 0, TOTAL_COLS, TOTAL_ROWS, 0);
+		trailLen = 0;
+		lastBallCol = prevPos.prev_Col / 10 - 1;
+		lastBallRow = prevPos.prev_Row / 10 - 1;
+#endif
+
+		// set game over message, the moving objects are stopped
+		// while the static layer is selected
+		select_Layer(LAYER_STATIC);
 		writeGameOver();
 		writeScore(score);
 		score = 0;
+		// the periodic refresh is paused, the banner is sent here
+		refreshNow();
+#if LCD_SLICED_REFRESH
+		reportSliceTime();
+#endif
 		HAL_Delay(GAME_OVER_DELAY);
 		init_DisplayArray();
+		select_Layer(LAYER_DYNAMIC);
+#if LCD_GRAYSCALE
+		gray_Fill_Rect(0, GRAY_LANE_ROW, TOTAL_COLS, GRAY_LANE_HEIGHT,
+				GRAY_LANE_LEVEL);
+#endif
+
+		// the ball and the lines at their starting positions
+		scene_Move(ballObject, prevPos.prev_Col / 10 - 1,
+				prevPos.prev_Row / 10 - 1);
+		scene_Move(upperLineObject, lineCol, START_OF_UPPER_LINE);
+		scene_Move(lowerLineObject, lineColSlowMove, START_OF_LOWER_LINE);
+		scene_Show(ballObject, 1);
+		scene_Show(upperLineObject, 1);
+		scene_Show(lowerLineObject, 1);
 		refresh();
+		drawPaused = 0;
 
 		// Reset game End flag, so game can be played again
 		gameEnd = 0;
@@ -89,41 +240,180 @@ void app_loop(void) {
 }
 
 /**
- * Used to write the Score on the display array
- * Write score if score is less then 100
+ * uart 2 received a byte, a perf dump is requested with PERF_DUMP_CMD,
+ * the next byte is received again in the background
+ */
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
+	if (huart == &huart2) {
+		if (uartCommand == PERF_DUMP_CMD) {
+			perfDumpRequested = 1;
+		} else if (uartCommand == MIRROR_TOGGLE_CMD) {
+			mirror_Enable(!mirror_Is_Enabled());
+		}
+		HAL_UART_Receive_IT(&huart2, &uartCommand, 1);
+	}
+}
+
+/**
+ * print the i2c speed and the measurements of the display entry points
+ * and the sensor transactions on uart 2, one line per entry point
+ */
+void dumpPerf() {
+	char line[PERF_LINE_LEN];
+	int busLen = snprintf(line, sizeof(line), "i2c %lu Hz\r\n",
+			(unsigned long) MPU_I2C_SPEED);
+	HAL_UART_Transmit(&huart2, line, busLen, HAL_MAX_DELAY);
+	for (int i = -1; i < PERF_ENTRIES; i++) {
+		int len = perf_Format(i, line, sizeof(line));
+		HAL_UART_Transmit(&huart2, line, len, HAL_MAX_DELAY);
+	}
+}
+
+/**
+ * Used to write the Score on the display array,
+ * centred below the game over message with at least two digits,
+ * a score too wide for the score digits is written in the small font
  */
 void writeScore(int score) {
-	if (score < MAX_SCORE) {
-		int unit = score % 10;
-		score = score / 10;
-		int ten = (score) % 10;
-		writeNumber(unit, UNIT_COL_SHIFT_VAL);
-		writeNumber(ten, TEN_COL_SHIFT_VAL);
+	const struct font *font = &scoreFont;
+	if (get_Number_Width(score, SCORE_MIN_DIGITS, font) > TOTAL_COLS) {
+		font = &smallFont;
 	}
+	int width = get_Number_Width(score, SCORE_MIN_DIGITS, font);
+	drawNumber(score, SCORE_MIN_DIGITS, SCORE_CENTER_COL - width / 2,
+			SCORE_ROW, font);
 }
 
 /**
  * Used to get the data from the MPU6050 Sensor, also do error handling
  * print the result for debugging, also check if there some kind of reading error
  * if readData()  returns 0 then it is reading Error which is to be transmitted via UART
- * if not then the result is printed for debugging 
+ * if not then the result is printed for debugging.
+ * With a background acquisition the read is only started here,
+ * the sample and the errors are handled in app_loop
  */
 int getMpuData() {
+#if MPU_ACQ_MODE == MPU_ACQ_BLOCKING
 	if (readData() != 1) {
 		HAL_UART_Transmit(&huart2, "Reading Error ...", 17, HAL_MAX_DELAY);
 	} else {
 		printResult();
 	}
+#else
+	startRead();
+#endif
 }
 
 /**
  * refresh screen,
- * set the content on the Lcd 
+ * the changes of the moving objects are drawn, the frame is presented and
+ * set on the Lcd 
  */
 void refresh() {
+#if LCD_GRAYSCALE
+	if (gameEnd == 0) {
+		drawTrail();
+	}
+#endif
+	scene_Update();
+	present();
+	mirror_Frame();
+#if LCD_DMA_REFRESH
+	// runs in the background, the frame is skipped while the last one is still sent
+	refresh_Screen_Dma();
+#elif LCD_SLICED_REFRESH
+	// sent by refreshSlice, a few bytes every tick
+#else
+	refreshScreen();
+#endif
+}
+
+/**
+ * periodic refresh, skipped while app_loop draws the game over screen
+ */
+void refreshTick() {
+	if (!drawPaused) {
+		refresh();
+	}
+}
+
+/**
+ * present the frame and send all of it at once, a running background
+ * refresh is finished first so the frame is not skipped.
+ * Used before the periodic refresh is registered and while it is paused
+ */
+void refreshNow() {
+#if LCD_DMA_REFRESH
+	while (refresh_In_Progress())
+		;
+#endif
+	present();
 	refreshScreen();
 }
 
+#if LCD_SLICED_REFRESH
+/**
+ * send the next slice of the presented frame,
+ * called every tick so the frame is on the lcd within REFRESH_RATE ticks
+ */
+void refreshSlice() {
+	refresh_Screen_Slice();
+}
+
+/**
+ * print the longest refresh slice, used to tune LCD_SLICE_WRITES
+ */
+void reportSliceTime() {
+	char buff[32];
+	int len = sprintf(buff, "max slice: %lu us\n",
+			(unsigned long) get_Max_Slice_Time_Us());
+	HAL_UART_Transmit(&huart2, buff, len, HAL_MAX_DELAY);
+}
+#endif
+
+#if LCD_GRAYSCALE
+/**
+ * step to the next gray phase, the dimmed pixels are sent by the
+ * sliced refresh within GRAY_PHASE_RATE ticks or by the background refresh
+ */
+void grayPhase() {
+	if (drawPaused) {
+		return;
+	}
+	gray_Next_Phase();
+#if LCD_DMA_REFRESH
+	refresh_Screen_Dma();
+#endif
+}
+
+/**
+ * Draw the fading trail behind the ball, the positions of the ball in
+ * the last GRAY_TRAIL_LEN frames get lower gray levels the older they are.
+ * A ball which stops moving takes its trail in after GRAY_TRAIL_LEN frames
+ */
+void drawTrail() {
+	for (int i = 0; i < trailLen; i++) {
+		gray_Blit(&ballSprite, trailCol[i], trailRow[i], 0);
+	}
+	for (int i = GRAY_TRAIL_LEN - 1; i > 0; i--) {
+		trailCol[i] = trailCol[i - 1];
+		trailRow[i] = trailRow[i - 1];
+	}
+	trailCol[0] = lastBallCol;
+	trailRow[0] = lastBallRow;
+	if (trailLen < GRAY_TRAIL_LEN) {
+		trailLen++;
+	}
+	lastBallCol = prevPos.prev_Col / 10 - 1;
+	lastBallRow = prevPos.prev_Row / 10 - 1;
+
+	// the oldest first, so the newer positions are drawn on top
+	for (int i = trailLen - 1; i >= 0; i--) {
+		gray_Blit(&ballSprite, trailCol[i], trailRow[i], GRAY_TRAIL_LEN - i);
+	}
+}
+#endif
+
 /**
  * For collision detection
  * 0 for lower line, else do collision detection for upper line 
@@ -156,8 +446,7 @@ void ballMovementWithSpeed() {
 
 	if (newRow < 630 && newCol < 1270 && newRow >= 0 && newCol >= 0) {
 		if (gameEnd == 0) {
-			set_Ball_To_Position(prevPos.prev_Row / 10, prevPos.prev_Col / 10, 0);
-			set_Ball_To_Position(newRow / 10, newCol / 10, 1);
+			scene_Move(ballObject, newCol / 10 - 1, newRow / 10 - 1);
 			prevPos.prev_Row = newRow;
 			prevPos.prev_Col = newCol;
 
@@ -176,8 +465,7 @@ void ballMovementWithSpeed() {
  */
 void moveLine() {
 	if (gameEnd == 0) {
-		draw_Vert_Line(START_OF_UPPER_LINE, lineCol, LENGTH_UPPER_LINE, 1);
-		draw_Vert_Line(START_OF_UPPER_LINE, lineCol + 1, LENGTH_UPPER_LINE, 0);
+		scene_Move(upperLineObject, lineCol, START_OF_UPPER_LINE);
 		if (lineCol < 0) {
 			lineCol = START_LINE_COL_VALUE;
 			score++;
@@ -196,10 +484,7 @@ void moveLine() {
  */
 void slowMoveLine() {
 	if (gameEnd == 0) {
-		draw_Vert_Line(START_OF_LOWER_LINE, lineColSlowMove,
-				LENGTH_OF_LOWER_LINE, 1);
-		draw_Vert_Line(START_OF_LOWER_LINE, lineColSlowMove + 1,
-				LENGTH_OF_LOWER_LINE, 0);
+		scene_Move(lowerLineObject, lineColSlowMove, START_OF_LOWER_LINE);
 		if (lineColSlowMove < 0) {
 			lineColSlowMove = START_LINE_COL_VALUE;
 			score++;
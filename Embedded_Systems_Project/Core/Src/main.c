@@ -25,6 +25,8 @@
 /* USER CODE BEGIN Includes */
 #include<string.h>
 #include <math.h>
+#include "Dem128064B.h"
+#include "mpu6050.h"
 
 //#include "uart.h"
 
@@ -52,7 +54,10 @@ TIM_HandleTypeDef htim10;
 UART_HandleTypeDef huart2;
 
 /* USER CODE BEGIN PV */
-
+#if LCD_DMA_REFRESH
+TIM_HandleTypeDef htim1;
+DMA_HandleTypeDef hdma_tim1_up;
+#endif
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -62,7 +67,15 @@ static void MX_USART2_UART_Init(void);
 static void MX_I2C1_Init(void);
 static void MX_TIM10_Init(void);
 /* USER CODE BEGIN PFP */
-
+#if LCD_DMA_REFRESH
+static void LCD_DMA_Init(void);
+#endif
+#if MPU_ACQ_MODE != MPU_ACQ_BLOCKING
+static void MPU_I2C_IT_Init(void);
+#endif
+#if MPU_DATA_READY_INT
+static void MPU_INT_Init(void);
+#endif
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -102,6 +115,15 @@ int main(void) {
 	MX_TIM10_Init();
 	/* USER CODE BEGIN 2 */
 	HAL_TIM_Base_Start(&htim10);
+#if LCD_DMA_REFRESH
+	LCD_DMA_Init();
+#endif
+#if MPU_ACQ_MODE != MPU_ACQ_BLOCKING
+	MPU_I2C_IT_Init();
+#endif
+#if MPU_DATA_READY_INT
+	MPU_INT_Init();
+#endif
 	app_init();
 
 	/* USER CODE END 2 */
@@ -185,6 +207,7 @@ static void MX_I2C1_Init(void) {
 		Error_Handler();
 	}
 	/* USER CODE BEGIN I2C1_Init 2 */
+	// the bus speed of the sensor is set by mpu6050_init (MPU_I2C_SPEED)
 
 	/* USER CODE END I2C1_Init 2 */
 
@@ -297,6 +320,83 @@ static void MX_GPIO_Init(void) {
 
 /* USER CODE BEGIN 4 */
 
+#if LCD_DMA_REFRESH
+/**
+ * @brief Timer 1 and DMA2 stream 5 for the background LCD refresh.
+ * Every timer 1 update event (LCD_DMA_STEP_US) moves one word
+ * from memory to GPIOC->BSRR
+ * @retval None
+ */
+static void LCD_DMA_Init(void) {
+	__HAL_RCC_TIM1_CLK_ENABLE();
+	__HAL_RCC_DMA2_CLK_ENABLE();
+
+	// 84 MHz / 84 = 1 MHz timer clock
+	htim1.Instance = TIM1;
+	htim1.Init.Prescaler = 83;
+	htim1.Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim1.Init.Period = LCD_DMA_STEP_US - 1;
+	htim1.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	htim1.Init.RepetitionCounter = 0;
+	htim1.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	if (HAL_TIM_Base_Init(&htim1) != HAL_OK) {
+		Error_Handler();
+	}
+
+	hdma_tim1_up.Instance = DMA2_Stream5;
+	hdma_tim1_up.Init.Channel = DMA_CHANNEL_6;
+	hdma_tim1_up.Init.Direction = DMA_MEMORY_TO_PERIPH;
+	hdma_tim1_up.Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma_tim1_up.Init.MemInc = DMA_MINC_ENABLE;
+	hdma_tim1_up.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	hdma_tim1_up.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	hdma_tim1_up.Init.Mode = DMA_NORMAL;
+	hdma_tim1_up.Init.Priority = DMA_PRIORITY_HIGH;
+	hdma_tim1_up.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+	if (HAL_DMA_Init(&hdma_tim1_up) != HAL_OK) {
+		Error_Handler();
+	}
+	__HAL_LINKDMA(&htim1, hdma[TIM_DMA_ID_UPDATE], hdma_tim1_up);
+
+	HAL_NVIC_SetPriority(DMA2_Stream5_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(DMA2_Stream5_IRQn);
+}
+#endif
+
+#if MPU_ACQ_MODE != MPU_ACQ_BLOCKING
+/**
+ * @brief The I2C1 interrupts for the background reads of the MPU6050,
+ * the event and error interrupts run the whole transaction
+ * @retval None
+ */
+static void MPU_I2C_IT_Init(void) {
+	HAL_NVIC_SetPriority(I2C1_EV_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(I2C1_EV_IRQn);
+	HAL_NVIC_SetPriority(I2C1_ER_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(I2C1_ER_IRQn);
+}
+#endif
+
+#if MPU_DATA_READY_INT
+/**
+ * @brief MPU_INT_Pin (PA10, D2) as EXTI input for the data ready
+ * interrupt of the MPU6050, every rising edge starts a read.
+ * The sensor only pulses INT after enableDataReady
+ * @retval None
+ */
+static void MPU_INT_Init(void) {
+	GPIO_InitTypeDef GPIO_InitStruct = { 0 };
+
+	GPIO_InitStruct.Pin = MPU_INT_Pin;
+	GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
+	GPIO_InitStruct.Pull = GPIO_PULLDOWN;
+	HAL_GPIO_Init(MPU_INT_GPIO_Port, &GPIO_InitStruct);
+
+	HAL_NVIC_SetPriority(MPU_INT_EXTI_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(MPU_INT_EXTI_IRQn);
+}
+#endif
+
 /* USER CODE END 4 */
 
 /**
@@ -0,0 +1,156 @@
+#include <string.h>
+#include "mirror.h"
+#include "main.h"
+#include "Dem128064B.h"
+
+/**
+ * sending a packet, in the background by the uart interrupt,
+ * the host build replaces both to capture the packets
+ */
+#ifndef MIRROR_SEND
+extern UART_HandleTypeDef huart2;
+#define MIRROR_SEND(packet, len) HAL_UART_Transmit_IT(&huart2, (packet), (len))
+#define MIRROR_BUSY() (huart2.gState != HAL_UART_STATE_READY)
+#endif
+
+/**
+ * frame shown on the lcd and the last frame sent, page major
+ */
+static uint8_t mirrorFrame[MIRROR_FRAME_LEN];
+static uint8_t mirrorPrevious[MIRROR_FRAME_LEN];
+
+/**
+ * packet being sent, must stay unchanged until the uart is done
+ */
+static uint8_t mirrorPacket[MIRROR_PACKET_MAX];
+
+static int mirrorEnabled = 0;
+static uint8_t mirrorSeq = 0;
+static uint32_t sentFrames = 0;
+static uint32_t skippedFrames = 0;
+
+/**
+ * turn the mirror on or off, the first frame sent is a key frame
+ */
+void mirror_Enable(int enable) {
+	mirrorEnabled = enable;
+	mirrorSeq = 0;
+	sentFrames = 0;
+	skippedFrames = 0;
+}
+
+int mirror_Is_Enabled() {
+	return mirrorEnabled;
+}
+
+uint32_t mirror_Get_Sent_Frames() {
+	return sentFrames;
+}
+
+uint32_t mirror_Get_Skipped_Frames() {
+	return skippedFrames;
+}
+
+/**
+ * number of unchanged bytes starting at index, counts at most limit
+ */
+static int unchanged_Len(const uint8_t *frame, const uint8_t *previous,
+		int index, int limit) {
+	int len = 0;
+	while (index + len < MIRROR_FRAME_LEN && len < limit
+			&& frame[index + len] == previous[index + len]) {
+		len++;
+	}
+	return len;
+}
+
+/**
+ * code the delta of frame to previous as runs into packet,
+ * previous is updated to frame, return the length of the packet
+ */
+int mirror_Encode(const uint8_t *frame, uint8_t *previous, uint8_t seq,
+		uint8_t flags, uint8_t scroll, uint8_t *packet) {
+	uint8_t *payload = packet + MIRROR_HEADER_LEN;
+	int len = 0;
+	int i = 0;
+
+	while (i < MIRROR_FRAME_LEN) {
+		int unchanged = unchanged_Len(frame, previous, i, MIRROR_FRAME_LEN);
+		if (i + unchanged == MIRROR_FRAME_LEN) {
+			// the rest is unchanged, nothing to send
+			break;
+		}
+		if (unchanged >= MIRROR_MIN_SKIP) {
+			i += unchanged;
+			while (unchanged > 0) {
+				int run = unchanged > MIRROR_RUN_MAX ? MIRROR_RUN_MAX : unchanged;
+				payload[len++] = run - 1;
+				unchanged -= run;
+			}
+			continue;
+		}
+
+		// changed bytes, short unchanged gaps are sent with them
+		int start = i;
+		while (i < MIRROR_FRAME_LEN && i - start < MIRROR_RUN_MAX) {
+			if (frame[i] == previous[i]) {
+				int gap = unchanged_Len(frame, previous, i, MIRROR_MIN_SKIP);
+				if (gap >= MIRROR_MIN_SKIP || i + gap == MIRROR_FRAME_LEN) {
+					break;
+				}
+			}
+			i++;
+		}
+		payload[len++] = 0x80 | (i - start - 1);
+		for (int j = start; j < i; j++) {
+			payload[len++] = frame[j] ^ previous[j];
+			previous[j] = frame[j];
+		}
+	}
+
+	packet[0] = MIRROR_SYNC1;
+	packet[1] = MIRROR_SYNC2;
+	packet[2] = seq;
+	packet[3] = flags;
+	packet[4] = scroll;
+	packet[5] = len & 0xFF;
+	packet[6] = len >> 8;
+	uint8_t checksum = 0;
+	for (int j = 2; j < MIRROR_HEADER_LEN + len; j++) {
+		checksum ^= packet[j];
+	}
+	packet[MIRROR_HEADER_LEN + len] = checksum;
+	return MIRROR_HEADER_LEN + len + MIRROR_TRAILER_LEN;
+}
+
+/**
+ * send the changes of the frame shown on the lcd since the last sent frame,
+ * every MIRROR_KEY_INTERVAL frames it is coded against an empty frame.
+ * The rows are sent unscrolled, a scroll only changes the new rows
+ */
+void mirror_Frame() {
+	if (!mirrorEnabled) {
+		return;
+	}
+	if (MIRROR_BUSY()) {
+		// the changes are sent with the next frame
+		skippedFrames++;
+		return;
+	}
+
+	for (int page = 0; page < TOTAL_PAGES; page++) {
+		for (int col = 0; col < TOTAL_COLS; col++) {
+			mirrorFrame[page * TOTAL_COLS + col] = get_Output_Byte(page, col);
+		}
+	}
+	uint8_t flags = 0;
+	if (sentFrames % MIRROR_KEY_INTERVAL == 0) {
+		memset(mirrorPrevious, 0, sizeof(mirrorPrevious));
+		flags = MIRROR_FLAG_KEY;
+	}
+	int len = mirror_Encode(mirrorFrame, mirrorPrevious, mirrorSeq, flags,
+			get_Presented_Scroll(), mirrorPacket);
+	MIRROR_SEND(mirrorPacket, len);
+	mirrorSeq++;
+	sentFrames++;
+}
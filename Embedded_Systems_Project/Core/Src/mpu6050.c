@@ -1,15 +1,89 @@
 #include "mpu6050.h"
 #include "main.h"
+#include "perf.h"
 
 extern I2C_HandleTypeDef hi2c1;
 extern UART_HandleTypeDef huart2;
 
 /**
- * Accelerometer data for x, y and z axis
+ * Sensor data registers of the last burst
  */
-uint8_t AcceleroX[2];
-uint8_t AcceleroY[2];
-uint8_t AcceleroZ[2];
+uint8_t sensorData[SENSOR_DATA_LEN];
+
+/**
+ * last sample read
+ */
+struct mpu6050_sample mpuSample;
+
+/**
+ * Background read: running flag and start time, the sample published by
+ * the completion callback with its sequence number, the sequence number
+ * taken last and the failed reads
+ */
+static volatile int readBusy = 0;
+static uint32_t readStart = 0;
+static uint32_t readTicks = 0;
+static struct mpu6050_sample publishedSample;
+static volatile uint32_t sampleSeq = 0;
+static uint32_t takenSeq = 0;
+static volatile uint32_t readErrors = 0;
+
+#if MPU_FIFO_MODE
+/**
+ * step of the FIFO drain running in the background
+ */
+#define FIFO_PHASE_COUNT 0
+#define FIFO_PHASE_DATA 1
+#define FIFO_PHASE_RESET 2
+
+/**
+ * FIFO drain: running step, FIFO count, samples and data of the burst,
+ * USER_CTRL value written for a reset, reset needed after an error
+ */
+static volatile int fifoPhase = FIFO_PHASE_COUNT;
+static uint8_t fifoCount[2];
+static int fifoBatch = 0;
+static uint8_t fifoData[MPU_FIFO_BATCH_MAX * MPU_FIFO_FRAME_LEN];
+static uint8_t fifoResetValue = USER_CTRL_FIFO_EN | USER_CTRL_FIFO_RESET;
+static volatile int fifoResync = 0;
+
+/**
+ * time stamp of the first sample after the last FIFO reset
+ * and samples drained since
+ */
+static uint32_t fifoStartUs = 0;
+static uint32_t fifoSamples = 0;
+
+/**
+ * drained samples, written by the completion callback at fifoHead,
+ * taken by takeBatch at fifoTail
+ */
+static struct mpu6050_timed_sample fifoQueue[MPU_FIFO_QUEUE_LEN];
+static volatile uint32_t fifoHead = 0;
+static volatile uint32_t fifoTail = 0;
+static volatile uint32_t fifoOverflows = 0;
+static volatile uint32_t fifoDropped = 0;
+#endif
+
+/**
+ * registers written since start up, counted for the timing report
+ */
+static uint32_t registerWrites = 0;
+
+/**
+ * measure a transaction with the perf module, PERF_I2C_BEGIN at the start,
+ * PERF_I2C_END records duration and data bytes (no strobes on the i2c),
+ * a background read is recorded by its completion callback from readTicks
+ */
+#if PERF_ENABLED
+#define PERF_I2C_BEGIN() uint32_t perfStart = perf_Now()
+#define PERF_I2C_END(entry, bytes) perf_Record(entry, perfStart, bytes, 0)
+#define PERF_READ_DONE(bytes) perf_Record(PERF_MPU_BURST, readTicks, bytes, 0)
+#else
+#define PERF_I2C_BEGIN()
+#define PERF_I2C_END(entry, bytes) (void) (bytes)
+#define PERF_READ_DONE(bytes)
+#endif
 
 /**
  * accelerometer data for the hterm,
@@ -25,30 +99,88 @@ char buffZ[16];
 char buffTiltX[16];
 char buffTiltY[16];
 
+/**
+ * write one register of the sensor, return 0 if there is an error else 1
+ */
+static int writeRegister(uint8_t reg, uint8_t value) {
+	if (HAL_I2C_Mem_Write(&hi2c1, MPU_ADDRESS, reg, 1, &value, 1,
+			HAL_MAX_DELAY) != HAL_OK) {
+		return 0;
+	}
+	registerWrites++;
+	return 1;
+}
+
 /**
  * Initialization of Mpu sensor is done, Error handling, Accelerometer
  * configuration, return 0 if there is an error else return 1
+ * With MPU_DATA_READY_INT the sample rate and the INT pin are configured
+ * too, the interrupt itself is enabled by enableDataReady
  */
 int mpu6050_init() {
-	HAL_StatusTypeDef handleReturn;
+	// bus speed of the sensor
+	hi2c1.Init.ClockSpeed = MPU_I2C_SPEED;
+	hi2c1.Init.DutyCycle = MPU_I2C_DUTY_CYCLE;
+	if (HAL_I2C_Init(&hi2c1) != HAL_OK) {
+		return 0;
+	}
+
+	PERF_I2C_BEGIN();
+	uint32_t initWrites = registerWrites;
 	// PWR_MGMT_1
-	handleReturn = HAL_I2C_Mem_Write(&hi2c1, MPU_ADDRESS, PWR_MAGT_1_REG, 1,
-			0x00, 1,
-			HAL_MAX_DELAY);
-	if (handleReturn != HAL_OK) {
+	if (writeRegister(PWR_MAGT_1_REG, 0x00) != 1) {
 		return 0;
 	}
 
 	// ACCEL_CONFIG
-	handleReturn = HAL_I2C_Mem_Write(&hi2c1, MPU_ADDRESS, ACCEL_CONFIG_REG, 1,
-			0x00, 1,
-			HAL_MAX_DELAY);
-	if (handleReturn != HAL_OK) {
+	if (writeRegister(ACCEL_CONFIG_REG, 0x00) != 1) {
+		return 0;
+	}
+
+#if MPU_DATA_READY_INT
+	// one sample every SENSOR_REFRESH_RATE ms, INT pulses on new data
+	if (writeRegister(CONFIG_REG, MPU_DLPF_CFG) != 1
+			|| writeRegister(SMPLRT_DIV_REG, MPU_SAMPLE_RATE_DIV) != 1
+			|| writeRegister(INT_PIN_CFG_REG, INT_PIN_CFG_PULSE) != 1) {
 		return 0;
 	}
+#endif
+
+#if MPU_FIFO_MODE
+	// samples at 1 kHz into the FIFO, the FIFO itself is enabled by startFifo
+	uint8_t fifoEnable = FIFO_EN_ACCEL;
+#if MPU_FIFO_GYRO
+	fifoEnable |= FIFO_EN_GYRO;
+#endif
+	if (writeRegister(CONFIG_REG, MPU_DLPF_CFG) != 1
+			|| writeRegister(SMPLRT_DIV_REG, MPU_FIFO_SAMPLE_RATE_DIV) != 1
+			|| writeRegister(FIFO_EN_REG, fifoEnable) != 1) {
+		return 0;
+	}
+#endif
+	PERF_I2C_END(PERF_MPU_INIT, registerWrites - initWrites);
 	return 1;
 }
 
+/**
+ * Enable the data ready interrupt, called when the blocking accesses
+ * are done, from now on every sample starts a background read
+ */
+int enableDataReady() {
+	return writeRegister(INT_ENABLE_REG, INT_DATA_RDY_EN);
+}
+
+/**
+ * Start the FIFO service, called right before the drain is registered.
+ * The first startRead enables and resets the FIFO, so the samples which
+ * would pile up during the rest of the start up are no overflow
+ */
+void startFifo() {
+#if MPU_FIFO_MODE
+	fifoResync = 1;
+#endif
+}
+
 /**
  * Check if working or not
  * return 1 for working else 0
@@ -58,9 +190,11 @@ int mpu6050_init() {
  * then 1 returned(sensor is working) else 0
  */
 int isWorking() {
-	uint8_t whoReg;
+	uint8_t whoReg = 0;
+	PERF_I2C_BEGIN();
 	HAL_I2C_Mem_Read(&hi2c1, MPU_ADDRESS, REG_WHO_AM, 1, &whoReg, 1,
 			HAL_MAX_DELAY);
+	PERF_I2C_END(PERF_MPU_WHO_AM_I, 1);
 	if (whoReg == 0x68) {
 		return 1;
 	}
@@ -71,42 +205,383 @@ int isWorking() {
  * read data
  * return 0 if fails,
  * error handling if return is not HAL_OK
- * value is to be checked before it goes to asin because asin function should not
- * take value more the 1 or less then -1 otherwise nun is returned by this function
- * Data is read from the sensor using I2C after data is read from the sensor
- * it is stored in array ACCEL_XOUT for x-axis ACCEL_YOUT for y axis and
- * ACCEL_ZOUT for z-axis, then all the data is for every single axis is combined to
- * 16 bit variables totalX, totalY and totalZ are the variables used for that
- *
+ * Data is read from the sensor using I2C, all sensor registers starting
+ * at ACCEL_XOUT in one transaction, so start, address and register pointer
+ * are sent once and all values belong to the same sample
  */
 int readData() {
 	HAL_StatusTypeDef handleReturn;
 
+	PERF_I2C_BEGIN();
 	handleReturn = HAL_I2C_Mem_Read(&hi2c1, MPU_ADDRESS, ACCEL_XOUT, 1,
-			AcceleroX, 2,
+			sensorData, SENSOR_DATA_LEN,
 			HAL_MAX_DELAY);
 	if (handleReturn != HAL_OK) {
 		return 0;
 	}
+	PERF_I2C_END(PERF_MPU_BURST, SENSOR_DATA_LEN);
 
-	handleReturn = HAL_I2C_Mem_Read(&hi2c1, MPU_ADDRESS, ACCEL_YOUT, 1,
-			AcceleroY, 2,
-			HAL_MAX_DELAY);
+	decodeSample(sensorData, &mpuSample);
+	calculateAngles(&mpuSample);
+	return 1;
+}
+
+/**
+ * start a background read of len bytes starting at register reg
+ */
+static HAL_StatusTypeDef startMemRead(uint8_t reg, uint8_t *data,
+		uint16_t len) {
+	return HAL_I2C_Mem_Read_IT(&hi2c1, MPU_ADDRESS, reg, 1, data, len);
+}
+
+#if MPU_FIFO_MODE
+/**
+ * start clearing the FIFO, the samples in it are dropped
+ */
+static HAL_StatusTypeDef startFifoReset() {
+	fifoPhase = FIFO_PHASE_RESET;
+	return HAL_I2C_Mem_Write_IT(&hi2c1, MPU_ADDRESS, USER_CTRL_REG, 1,
+			&fifoResetValue, 1);
+}
+
+/**
+ * queue the samples of a FIFO burst with their time stamps,
+ * a sample is dropped when the queue is full
+ */
+static void queueFifoSamples(const uint8_t *data, int samples) {
+	for (int i = 0; i < samples; i++) {
+		const uint8_t *frame = data + i * MPU_FIFO_FRAME_LEN;
+		uint32_t timeUs = fifoStartUs + fifoSamples * MPU_FIFO_SAMPLE_US;
+		fifoSamples++;
+		if (fifoHead - fifoTail >= MPU_FIFO_QUEUE_LEN) {
+			fifoDropped++;
+			continue;
+		}
+		struct mpu6050_timed_sample *entry = &fifoQueue[fifoHead
+				% MPU_FIFO_QUEUE_LEN];
+		entry->timeUs = timeUs;
+		entry->sample.accelX = ((uint16_t) frame[0] << 8) | frame[1];
+		entry->sample.accelY = ((uint16_t) frame[2] << 8) | frame[3];
+		entry->sample.accelZ = ((uint16_t) frame[4] << 8) | frame[5];
+		entry->sample.temperature = 0;
+#if MPU_FIFO_GYRO
+		entry->sample.gyroX = ((uint16_t) frame[6] << 8) | frame[7];
+		entry->sample.gyroY = ((uint16_t) frame[8] << 8) | frame[9];
+		entry->sample.gyroZ = ((uint16_t) frame[10] << 8) | frame[11];
+#else
+		entry->sample.gyroX = 0;
+		entry->sample.gyroY = 0;
+		entry->sample.gyroZ = 0;
+#endif
+		fifoHead++;
+	}
+}
+
+/**
+ * the FIFO count is read, a full FIFO or a count which is not a multiple
+ * of the frame has lost samples and is reset, else the complete frames
+ * are read in one burst
+ */
+static void fifoCountRead() {
+	uint16_t count = ((uint16_t) fifoCount[0] << 8) | fifoCount[1];
+	HAL_StatusTypeDef handleReturn;
+
+	if (count >= MPU_FIFO_SIZE || count % MPU_FIFO_FRAME_LEN != 0) {
+		fifoOverflows++;
+		handleReturn = startFifoReset();
+	} else {
+		int samples = count / MPU_FIFO_FRAME_LEN;
+		if (samples == 0) {
+			PERF_READ_DONE(sizeof(fifoCount));
+			readBusy = 0;
+			return;
+		}
+		if (samples > MPU_FIFO_BATCH_MAX) {
+			samples = MPU_FIFO_BATCH_MAX;
+		}
+		fifoPhase = FIFO_PHASE_DATA;
+		fifoBatch = samples;
+		handleReturn = startMemRead(FIFO_R_W_REG, fifoData,
+				samples * MPU_FIFO_FRAME_LEN);
+	}
 	if (handleReturn != HAL_OK) {
-		return 0;
+		fifoResync = 1;
+		readErrors++;
+		readBusy = 0;
 	}
+}
+#endif
 
-	handleReturn = HAL_I2C_Mem_Read(&hi2c1, MPU_ADDRESS, ACCEL_ZOUT, 1,
-			AcceleroZ, 2,
-			HAL_MAX_DELAY);
+/**
+ * half a clock period of the bus recovery
+ */
+static void recoveryDelay() {
+	for (volatile int i = 0; i < MPU_RECOVERY_DELAY_LOOPS; i++)
+		;
+}
+
+/**
+ * Free a bus held low by the sensor. A read cut off in the middle of a byte
+ * leaves the sensor driving SDA low while it waits for the rest of the
+ * clocks, the i2c peripheral can not start again then. SCL and SDA are
+ * driven as open drain GPIO: SCL is clocked until SDA is released,
+ * then a STOP (SDA rising while SCL is high) ends the transaction.
+ * The i2c must be deinitialized before and initialized again after
+ */
+static void recoverBus() {
+	GPIO_InitTypeDef GPIO_InitStruct = { 0 };
+
+	HAL_GPIO_WritePin(MPU_I2C_GPIO_Port, MPU_SCL_Pin | MPU_SDA_Pin,
+			GPIO_PIN_SET);
+	GPIO_InitStruct.Pin = MPU_SCL_Pin | MPU_SDA_Pin;
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+	GPIO_InitStruct.Pull = GPIO_PULLUP;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	HAL_GPIO_Init(MPU_I2C_GPIO_Port, &GPIO_InitStruct);
+	recoveryDelay();
+
+	for (int i = 0; i < MPU_RECOVERY_CLOCKS
+			&& HAL_GPIO_ReadPin(MPU_I2C_GPIO_Port, MPU_SDA_Pin) == GPIO_PIN_RESET;
+			i++) {
+		HAL_GPIO_WritePin(MPU_I2C_GPIO_Port, MPU_SCL_Pin, GPIO_PIN_RESET);
+		recoveryDelay();
+		HAL_GPIO_WritePin(MPU_I2C_GPIO_Port, MPU_SCL_Pin, GPIO_PIN_SET);
+		recoveryDelay();
+	}
+
+	// STOP
+	HAL_GPIO_WritePin(MPU_I2C_GPIO_Port, MPU_SCL_Pin, GPIO_PIN_RESET);
+	recoveryDelay();
+	HAL_GPIO_WritePin(MPU_I2C_GPIO_Port, MPU_SDA_Pin, GPIO_PIN_RESET);
+	recoveryDelay();
+	HAL_GPIO_WritePin(MPU_I2C_GPIO_Port, MPU_SCL_Pin, GPIO_PIN_SET);
+	recoveryDelay();
+	HAL_GPIO_WritePin(MPU_I2C_GPIO_Port, MPU_SDA_Pin, GPIO_PIN_SET);
+	recoveryDelay();
+}
+
+/**
+ * Abort a hung transfer, free the bus and initialize the i2c again,
+ * counted as a failed read. In MPU_FIFO_MODE the FIFO is out of step then
+ */
+static void resetBus() {
+	HAL_I2C_DeInit(&hi2c1);
+	recoverBus();
+	HAL_I2C_Init(&hi2c1);
+	readBusy = 0;
+	readErrors++;
+#if MPU_FIFO_MODE
+	fifoResync = 1;
+#endif
+}
+
+/**
+ * Start a background read of all sensor registers, called from the SysTick
+ * handler, so it only starts the transfer. A read which still runs after
+ * MPU_READ_TIMEOUT_MS is taken as a hung bus and the bus is reset, so the
+ * next call can start a new read. The bus is reset too when it is busy
+ * before the start (SDA held low, or the busy flag stuck), the HAL would
+ * wait about 25 ms for it in this handler and fail, and when the start fails.
+ * In MPU_FIFO_MODE the FIFO count is read first, the completion callback
+ * then reads the samples, a FIFO left in an unknown state is reset first
+ */
+int startRead() {
+	if (readBusy) {
+		if (HAL_GetTick() - readStart < MPU_READ_TIMEOUT_MS) {
+			return 0;
+		}
+		resetBus();
+	}
+	if (__HAL_I2C_GET_FLAG(&hi2c1, I2C_FLAG_BUSY) != RESET) {
+		resetBus();
+	}
+
+	HAL_StatusTypeDef handleReturn;
+	readBusy = 1;
+	readStart = HAL_GetTick();
+#if PERF_ENABLED
+	readTicks = perf_Now();
+#endif
+#if MPU_FIFO_MODE
+	if (fifoResync) {
+		handleReturn = startFifoReset();
+	} else {
+		fifoPhase = FIFO_PHASE_COUNT;
+		handleReturn = HAL_I2C_Mem_Read_IT(&hi2c1, MPU_ADDRESS, FIFO_COUNT_REG,
+				1, fifoCount, sizeof(fifoCount));
+	}
+#else
+	handleReturn = startMemRead(ACCEL_XOUT, sensorData, SENSOR_DATA_LEN);
+#endif
 	if (handleReturn != HAL_OK) {
+		resetBus();
 		return 0;
 	}
+	return 1;
+}
+
+/**
+ * the background read is complete, publish the sample
+ * (MPU_FIFO_MODE: read the samples or queue them)
+ */
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+	if (hi2c != &hi2c1) {
+		return;
+	}
+#if MPU_FIFO_MODE
+	if (fifoPhase == FIFO_PHASE_COUNT) {
+		fifoCountRead();
+		return;
+	}
+	queueFifoSamples(fifoData, fifoBatch);
+	PERF_READ_DONE(sizeof(fifoCount) + fifoBatch * MPU_FIFO_FRAME_LEN);
+#else
+	decodeSample(sensorData, &publishedSample);
+	sampleSeq++;
+	PERF_READ_DONE(SENSOR_DATA_LEN);
+#endif
+	readBusy = 0;
+}
 
-	// copy the accelerometer data to 16bit variable
-	int16_t totalX = ((uint16_t) AcceleroX[0] << 8) | (uint16_t) AcceleroX[1];
-	int16_t totalY = ((uint16_t) AcceleroY[0] << 8) | (uint16_t) AcceleroY[1];
-	int16_t totalZ = ((uint16_t) AcceleroZ[0] << 8) | (uint16_t) AcceleroZ[1];
+#if MPU_FIFO_MODE
+/**
+ * the FIFO is reset, the time stamps start again
+ */
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+	if (hi2c == &hi2c1) {
+		fifoStartUs = HAL_GetTick() * 1000;
+		fifoSamples = 0;
+		fifoResync = 0;
+		readBusy = 0;
+	}
+}
+#endif
+
+#if MPU_DATA_READY_INT
+/**
+ * rising edge of the INT line, the sensor has a new sample
+ */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+	if (GPIO_Pin == MPU_INT_Pin) {
+		startRead();
+	}
+}
+#endif
+
+/**
+ * the background read failed, the next startRead tries again
+ */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+	if (hi2c == &hi2c1) {
+#if MPU_FIFO_MODE
+		// a part of a frame may be read, the FIFO is out of step
+		fifoResync = 1;
+#endif
+		readErrors++;
+		readBusy = 0;
+	}
+}
+
+/**
+ * copy the newest published sample, copied again when the callback
+ * published a new one while copying
+ */
+int takeSample(struct mpu6050_sample *sample) {
+	uint32_t seq;
+	do {
+		seq = sampleSeq;
+		*sample = publishedSample;
+	} while (seq != sampleSeq);
+
+	if (seq == takenSeq) {
+		return 0;
+	}
+	takenSeq = seq;
+	return 1;
+}
+
+/**
+ * calculate the tilt angles from the newest published sample
+ */
+int processSample() {
+#if MPU_FIFO_MODE
+	struct mpu6050_timed_sample batch[MPU_FIFO_BATCH_MAX];
+	int taken = 0;
+	int count;
+	while ((count = takeBatch(batch, MPU_FIFO_BATCH_MAX)) > 0) {
+		mpuSample = batch[count - 1].sample;
+		taken = 1;
+	}
+	if (!taken) {
+		return 0;
+	}
+#else
+	if (takeSample(&mpuSample) != 1) {
+		return 0;
+	}
+#endif
+	calculateAngles(&mpuSample);
+	return 1;
+}
+
+uint32_t getReadErrors() {
+	return readErrors;
+}
+
+/**
+ * copy the oldest queued FIFO samples, the completion callback only
+ * writes behind fifoHead, so no copy has to be repeated
+ */
+int takeBatch(struct mpu6050_timed_sample *batch, int max) {
+	int count = 0;
+#if MPU_FIFO_MODE
+	while (count < max && fifoTail != fifoHead) {
+		batch[count++] = fifoQueue[fifoTail % MPU_FIFO_QUEUE_LEN];
+		fifoTail++;
+	}
+#endif
+	return count;
+}
+
+uint32_t getFifoOverflows() {
+#if MPU_FIFO_MODE
+	return fifoOverflows;
+#else
+	return 0;
+#endif
+}
+
+uint32_t getFifoDropped() {
+#if MPU_FIFO_MODE
+	return fifoDropped;
+#else
+	return 0;
+#endif
+}
+
+/**
+ * decode a burst of the sensor data registers,
+ * every value is combined from its high and low byte
+ */
+void decodeSample(const uint8_t *data, struct mpu6050_sample *sample) {
+	sample->accelX = ((uint16_t) data[0] << 8) | data[1];
+	sample->accelY = ((uint16_t) data[2] << 8) | data[3];
+	sample->accelZ = ((uint16_t) data[4] << 8) | data[5];
+	sample->temperature = ((uint16_t) data[6] << 8) | data[7];
+	sample->gyroX = ((uint16_t) data[8] << 8) | data[9];
+	sample->gyroY = ((uint16_t) data[10] << 8) | data[11];
+	sample->gyroZ = ((uint16_t) data[12] << 8) | data[13];
+}
+
+/**
+ * calculate the tilt angles
+ * value is to be checked before it goes to asin because asin function should not
+ * take value more the 1 or less then -1 otherwise nun is returned by this function
+ */
+void calculateAngles(const struct mpu6050_sample *sample) {
+	int16_t totalX = sample->accelX;
+	int16_t totalY = sample->accelY;
+	int16_t totalZ = sample->accelZ;
 
 	//totalX = (float) totalX/16384.0;
 	// to float type 
@@ -147,8 +622,6 @@ int readData() {
 	// copy Theta
 	sprintf(buffTiltX, "%.2f", allAngles.thetaX);
 	sprintf(buffTiltY, "%.2f", allAngles.thetaY);
-
-	return 1;
 }
 
 /**
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include "perf.h"
+#include "main.h"
+#ifdef LCD_HOST_SIM
+#include <time.h>
+#endif
+
+/**
+ * measurements of all entry points
+ */
+static struct perf_entry entries[PERF_ENTRIES];
+
+/**
+ * names of the entry points, same order as the PERF_ defines
+ */
+static const char *const entryNames[PERF_ENTRIES] = { "refreshScreen",
+		"refresh_Screen_Slice", "refresh_Screen_Dma", "clear_Screen",
+		"write_On_Screen", "write_Burst_On_Screen", "present", "mpu6050_init",
+		"isWorking", "mpu burst" };
+
+/**
+ * start the cycle counter and clear all measurements
+ */
+void perf_Init() {
+#ifndef LCD_HOST_SIM
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	perf_Reset();
+}
+
+/**
+ * clear all measurements
+ */
+void perf_Reset() {
+	for (int i = 0; i < PERF_ENTRIES; i++) {
+		entries[i].calls = 0;
+		entries[i].minTicks = UINT32_MAX;
+		entries[i].maxTicks = 0;
+		entries[i].totalTicks = 0;
+		entries[i].bytes = 0;
+		entries[i].strobes = 0;
+	}
+}
+
+/**
+ * current time in ticks, DWT cycles on target,
+ * nano seconds of the monotonic clock in the host build
+ */
+uint32_t perf_Now() {
+#ifdef LCD_HOST_SIM
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t) (now.tv_sec * 1000000000ULL + now.tv_nsec);
+#else
+	return DWT->CYCCNT;
+#endif
+}
+
+/**
+ * ticks per micro second
+ */
+uint32_t perf_Ticks_Per_Us() {
+#ifdef LCD_HOST_SIM
+	return 1000;
+#else
+	return SystemCoreClock / 1000000;
+#endif
+}
+
+/**
+ * record one call of an entry point, the tick counter may wrap around
+ * between start and now, the unsigned difference is still right
+ */
+void perf_Record(int entry, uint32_t start, uint32_t bytes, uint32_t strobes) {
+	uint32_t ticks = perf_Now() - start;
+	struct perf_entry *e = &entries[entry];
+	e->calls++;
+	e->totalTicks += ticks;
+	if (ticks < e->minTicks) {
+		e->minTicks = ticks;
+	}
+	if (ticks > e->maxTicks) {
+		e->maxTicks = ticks;
+	}
+	e->bytes += bytes;
+	e->strobes += strobes;
+}
+
+/**
+ * measurements of an entry point
+ */
+const struct perf_entry* perf_Get(int entry) {
+	return &entries[entry];
+}
+
+/**
+ * name of an entry point
+ */
+const char* perf_Name(int entry) {
+	return entryNames[entry];
+}
+
+/**
+ * write the header (entry -1) or the measurements of one entry point,
+ * times in micro seconds
+ */
+int perf_Format(int entry, char *buff, int size) {
+	if (entry < 0) {
+		return snprintf(buff, size, "%-22s %7s %8s %8s %8s %9s %9s\r\n",
+				"entry", "calls", "min us", "avg us", "max us", "bytes",
+				"strobes");
+	}
+	const struct perf_entry *e = &entries[entry];
+	uint32_t perUs = perf_Ticks_Per_Us();
+	uint32_t avg = e->calls > 0 ? (uint32_t) (e->totalTicks / e->calls) : 0;
+	uint32_t min = e->calls > 0 ? e->minTicks : 0;
+	return snprintf(buff, size, "%-22s %7lu %8lu %8lu %8lu %9lu %9lu\r\n",
+			entryNames[entry], (unsigned long) e->calls,
+			(unsigned long) (min / perUs), (unsigned long) (avg / perUs),
+			(unsigned long) (e->maxTicks / perUs), (unsigned long) e->bytes,
+			(unsigned long) e->strobes);
+}
@@ -23,6 +23,8 @@
 #include "stm32f4xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "Dem128064B.h"
+#include "mpu6050.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -59,6 +61,10 @@
 extern UART_HandleTypeDef huart2;
 /* USER CODE BEGIN EV */
 	uint16_t count = 0;
+#if LCD_DMA_REFRESH
+extern DMA_HandleTypeDef hdma_tim1_up;
+#endif
+extern I2C_HandleTypeDef hi2c1;
 /* USER CODE END EV */
 
 /******************************************************************************/
@@ -213,5 +219,43 @@ void USART2_IRQHandler(void)
 
 /* USER CODE BEGIN 1 */
 
+#if LCD_DMA_REFRESH
+/**
+  * @brief This function handles DMA2 stream5 global interrupt (background LCD refresh).
+  */
+void DMA2_Stream5_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_tim1_up);
+}
+#endif
+
+#if MPU_ACQ_MODE != MPU_ACQ_BLOCKING
+/**
+  * @brief This function handles I2C1 event interrupt.
+  */
+void I2C1_EV_IRQHandler(void)
+{
+  HAL_I2C_EV_IRQHandler(&hi2c1);
+}
+
+/**
+  * @brief This function handles I2C1 error interrupt.
+  */
+void I2C1_ER_IRQHandler(void)
+{
+  HAL_I2C_ER_IRQHandler(&hi2c1);
+}
+#endif
+
+#if MPU_DATA_READY_INT
+/**
+  * @brief This function handles EXTI line[15:10] interrupts (MPU6050 INT).
+  */
+void EXTI15_10_IRQHandler(void)
+{
+  HAL_GPIO_EXTI_IRQHandler(MPU_INT_Pin);
+}
+#endif
+
 /* USER CODE END 1 */
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,60 @@
+/**
+ * KS0108 bus simulator,
+ * decodes the PORTC levels written by the LCD driver into a simulated
+ * display with two KS0108 controllers (left and right half, 64 columns each).
+ * PORTC is sampled every time the driver reads the TIM10 counter,
+ * a falling enable edge latches a command or a data byte like the real controller.
+ * The simulator counts enable strobes and the modeled bus time in micro seconds.
+ * Packets of the uart mirror are captured into a file.
+ *
+ * Author Husnain Khan
+ */
+
+#ifndef KS0108_SIM_H
+#define KS0108_SIM_H
+
+#include <stdint.h>
+
+/**
+ * bus cost counters
+ */
+struct sim_counters {
+	uint32_t strobes;
+	uint32_t dataWrites;
+	uint32_t commands;
+	uint32_t busTimeUs;
+	uint32_t mirrorBytes;
+};
+
+/**
+ * reset the simulated display and the counters
+ */
+extern void sim_Reset(void);
+
+/**
+ * counters since sim_Reset
+ */
+extern struct sim_counters sim_Get_Counters(void);
+
+/**
+ * pixel byte the simulated lcd shows at page and column,
+ * the display start line of the controllers is applied
+ */
+extern uint8_t sim_Screen_Byte(int page, int col);
+
+/**
+ * write the visible screen as binary PBM image, return 0 on success
+ */
+extern int sim_Write_Pbm(const char *fileName);
+
+/**
+ * capture the packets of the uart mirror into a file, return 0 on success
+ */
+extern int sim_Mirror_Capture(const char *fileName);
+
+/**
+ * stop the capture and close the file
+ */
+extern void sim_Mirror_Close(void);
+
+#endif /* KS0108_SIM_H */
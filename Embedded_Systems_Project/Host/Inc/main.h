@@ -0,0 +1,104 @@
+/**
+ * Host stand-in for main.h, used to build the LCD driver (Dem128064B.c)
+ * on a Linux pc together with the KS0108 bus simulator.
+ * Only the parts of the HAL used by the driver are provided:
+ * GPIOC, the TIM10 counter used by getDelay and the DWT cycle counter.
+ * Every bus store and every read of the TIM10 counter samples PORTC,
+ * so the simulator sees every enable edge of the bus. Reading the counter
+ * advances the modeled time by one micro second.
+ * The packets of the uart mirror go to the simulator instead of uart 2.
+ *
+ * Author Husnain Khan
+ */
+
+#ifndef HOST_MAIN_H
+#define HOST_MAIN_H
+
+#include <stdint.h>
+
+/**
+ * GPIO port registers used by the driver
+ */
+typedef struct {
+	volatile uint32_t MODER;
+	volatile uint32_t IDR;
+	volatile uint32_t ODR;
+	volatile uint32_t BSRR;
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef sim_Gpioc;
+#define GPIOC (&sim_Gpioc)
+
+/**
+ * stores of the lcd bus words go through the simulator,
+ * so every bus phase is sampled
+ */
+#define LCD_BUS_STORE(word) sim_Bus_Store(word)
+
+/**
+ * store a word to GPIOC->BSRR and sample PORTC
+ */
+extern void sim_Bus_Store(uint32_t word);
+
+/**
+ * packets of the uart mirror are captured by the simulator,
+ * the uart is never busy
+ */
+#define MIRROR_SEND(packet, len) sim_Mirror_Send(packet, len)
+#define MIRROR_BUSY() 0
+
+/**
+ * capture a packet of the uart mirror
+ */
+extern void sim_Mirror_Send(const uint8_t *packet, int len);
+
+/**
+ * Timer handle, only used as a name
+ */
+typedef struct {
+	int unused;
+} TIM_HandleTypeDef;
+
+#define HAL_TIM_Base_Start(htim) ((void) (htim))
+#define __HAL_TIM_SET_COUNTER(htim, value) sim_Tim_Set_Counter(value)
+#define __HAL_TIM_GET_COUNTER(htim) sim_Tim_Get_Counter()
+
+/**
+ * set the TIM10 counter
+ */
+extern void sim_Tim_Set_Counter(uint32_t value);
+
+/**
+ * read the TIM10 counter, samples PORTC and advances time by 1 micro second
+ */
+extern uint32_t sim_Tim_Get_Counter(void);
+
+/**
+ * DWT cycle counter, advanced by the modeled bus time
+ */
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+	volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern DWT_Type sim_Dwt;
+extern CoreDebug_Type sim_CoreDebug;
+#define DWT (&sim_Dwt)
+#define CoreDebug (&sim_CoreDebug)
+#define DWT_CTRL_CYCCNTENA_Msk (1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+
+extern uint32_t SystemCoreClock;
+
+/**
+ * interrupt mask, the simulation has no interrupts
+ */
+#define __get_PRIMASK() 0U
+#define __set_PRIMASK(mask) ((void) (mask))
+#define __disable_irq()
+
+#endif /* HOST_MAIN_H */
@@ -0,0 +1,160 @@
+/**
+ * Host benchmark of the display array primitives.
+ * Every primitive (vertical line, horizontal line, rectangle fill, clear
+ * and invert) is timed against a per pixel version built from
+ * writeToDisplayArr / clearDisplayArr like the drawing code used before,
+ * and both versions must leave the same display array behind.
+ *
+ * Author Husnain Khan
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "main.h"
+#include "ks0108_sim.h"
+#include "Dem128064B.h"
+
+/**
+ * calls of every primitive per measurement
+ */
+#define BENCH_ROUNDS 20000
+
+/**
+ * back buffer of the driver
+ */
+extern uint8_t (*display)[TOTAL_COLS];
+
+/**
+ * one primitive, drawn with the driver and with the per pixel reference
+ */
+struct bench_case {
+	const char *name;
+	void (*fast)(int round);
+	void (*perPixel)(int round);
+};
+
+/**
+ * per pixel reference versions
+ */
+static void ref_Fill(int x, int y, int width, int height, int setClear) {
+	for (int row = y; row < y + height; row++) {
+		for (int col = x; col < x + width; col++) {
+			if (setClear == 1) {
+				writeToDisplayArr(row, col);
+			} else {
+				clearDisplayArr(row, col);
+			}
+		}
+	}
+}
+
+static void ref_Invert() {
+	for (int row = 0; row < TOTAL_ROWS; row++) {
+		for (int col = 0; col < TOTAL_COLS; col++) {
+			if (display[row / PAGE_LEN][col] & (1 << (row % PAGE_LEN))) {
+				clearDisplayArr(row, col);
+			} else {
+				writeToDisplayArr(row, col);
+			}
+		}
+	}
+}
+
+/**
+ * the cases, round moves the shapes so set and clear both do work
+ */
+static void fast_Vline(int round) {
+	draw_Vert_Line(3, round % TOTAL_COLS, 57, round & 1);
+}
+
+static void ref_Vline(int round) {
+	ref_Fill(round % TOTAL_COLS, 3, 1, 57, round & 1);
+}
+
+static void fast_Hline(int round) {
+	draw_Horiz_Line(round % TOTAL_ROWS, 1, 125);
+}
+
+static void ref_Hline(int round) {
+	ref_Fill(1, round % TOTAL_ROWS, 125, 1, 1);
+}
+
+static void fast_Fill(int round) {
+	fill_Rect(5, 3, 100, 50, (round & 1) ? ROP_OR : ROP_AND_NOT);
+}
+
+static void ref_FillRect(int round) {
+	ref_Fill(5, 3, 100, 50, round & 1);
+}
+
+static void fast_Clear(int round) {
+	fill_Rect(round % TOTAL_COLS, 0, 8, TOTAL_ROWS, ROP_OR);
+	init_DisplayArray();
+}
+
+static void ref_Clear(int round) {
+	fill_Rect(round % TOTAL_COLS, 0, 8, TOTAL_ROWS, ROP_OR);
+	for (int i = 0; i < TOTAL_PAGES; i++) {
+		for (int j = 0; j < TOTAL_COLS; j++) {
+			display[i][j] = 0;
+		}
+	}
+}
+
+static void fast_Invert(int round) {
+	invert_DisplayArr();
+}
+
+static void ref_InvertCase(int round) {
+	ref_Invert();
+}
+
+static const struct bench_case cases[] = {
+	{ "vline", fast_Vline, ref_Vline },
+	{ "hline", fast_Hline, ref_Hline },
+	{ "fill_rect", fast_Fill, ref_FillRect },
+	{ "clear", fast_Clear, ref_Clear },
+	{ "invert", fast_Invert, ref_InvertCase },
+};
+
+/**
+ * run one version of a case, return the time per call in nano seconds
+ */
+static double run_Case(void (*draw)(int round), uint8_t result[TOTAL_PAGES][TOTAL_COLS]) {
+	struct timespec start;
+	struct timespec end;
+
+	init_DisplayArray();
+	clear_Dirty();
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int round = 0; round < BENCH_ROUNDS; round++) {
+		draw(round);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	memcpy(result, display, TOTAL_PAGES * TOTAL_COLS);
+
+	double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+	return ns / BENCH_ROUNDS;
+}
+
+int main(void) {
+	static uint8_t fastResult[TOTAL_PAGES][TOTAL_COLS];
+	static uint8_t refResult[TOTAL_PAGES][TOTAL_COLS];
+	int failed = 0;
+
+	sim_Reset();
+	setUp();
+
+	printf("%-10s %14s %14s %8s %8s\n", "primitive", "per pixel ns",
+			"word ns", "speedup", "result");
+	for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		double refNs = run_Case(cases[i].perPixel, refResult);
+		double fastNs = run_Case(cases[i].fast, fastResult);
+		int same = memcmp(fastResult, refResult, sizeof(fastResult)) == 0;
+		printf("%-10s %14.1f %14.1f %7.1fx %8s\n", cases[i].name, refNs,
+				fastNs, refNs / fastNs, same ? "same" : "DIFFERS");
+		failed |= !same;
+	}
+	return failed;
+}
@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "ks0108_sim.h"
+#include "Dem128064B.h"
+
+/**
+ * PORTC, TIM10 and DWT stand-ins used by the driver
+ */
+GPIO_TypeDef sim_Gpioc;
+DWT_Type sim_Dwt;
+CoreDebug_Type sim_CoreDebug;
+TIM_HandleTypeDef htim10;
+uint32_t SystemCoreClock = 84000000;
+
+/**
+ * one KS0108 controller, 8 pages of 64 columns
+ */
+struct ks0108 {
+	uint8_t ram[TOTAL_PAGES][MAX_COLS_LCD];
+	uint8_t page;
+	uint8_t col;
+	uint8_t startLine;
+	uint8_t on;
+};
+
+static struct ks0108 chips[2];
+static struct sim_counters counters;
+
+/**
+ * TIM10 counter and the PORTC level seen at the last sample
+ */
+static uint32_t timCounter = 0;
+static uint32_t lastOdr = 0;
+
+/**
+ * capture file of the uart mirror packets
+ */
+static FILE *mirrorFile = NULL;
+
+/**
+ * reset the simulated display and the counters
+ */
+void sim_Reset() {
+	memset(chips, 0, sizeof(chips));
+	memset(&counters, 0, sizeof(counters));
+	memset(&sim_Gpioc, 0, sizeof(sim_Gpioc));
+	timCounter = 0;
+	lastOdr = 0;
+}
+
+/**
+ * counters since sim_Reset
+ */
+struct sim_counters sim_Get_Counters() {
+	return counters;
+}
+
+/**
+ * execute a command or data write on one controller
+ */
+static void chip_Write(struct ks0108 *chip, int dataMode, uint8_t value) {
+	if (dataMode) {
+		chip->ram[chip->page][chip->col] = value;
+		chip->col = (chip->col + 1) % MAX_COLS_LCD;
+	} else if ((value & 0xFE) == 0x3E) {
+		chip->on = value & 1;
+	} else if ((value & 0xC0) == COL_SEL_MASK) {
+		chip->col = value & 0x3F;
+	} else if ((value & 0xF8) == PAGE_SEL_MASK) {
+		chip->page = value & 0x07;
+	} else if ((value & 0xC0) == 0xC0) {
+		chip->startLine = value & 0x3F;
+	}
+}
+
+/**
+ * sample PORTC, a rising enable edge is counted as strobe,
+ * a falling edge latches the bus into the selected controllers
+ */
+static void sample_Port() {
+	if (sim_Gpioc.BSRR != 0) {
+		uint32_t bsrr = sim_Gpioc.BSRR;
+		sim_Gpioc.ODR = (sim_Gpioc.ODR & ~(bsrr >> 16)) | (bsrr & 0xFFFF);
+		sim_Gpioc.BSRR = 0;
+	}
+	uint32_t odr = sim_Gpioc.ODR;
+	int enable = (odr >> E_pos) & 1;
+	int lastEnable = (lastOdr >> E_pos) & 1;
+
+	if (enable && !lastEnable) {
+		counters.strobes++;
+	}
+	if (!enable && lastEnable && !((odr >> RW_pos) & 1)) {
+		// the latched values are the ones present while enable was high
+		int dataMode = (lastOdr >> DI_pos) & 1;
+		uint8_t value = lastOdr & 0xFF;
+		if (dataMode) {
+			counters.dataWrites++;
+		} else {
+			counters.commands++;
+		}
+		if ((lastOdr >> CS1_pos) & 1) {
+			chip_Write(&chips[0], dataMode, value);
+		}
+		if ((lastOdr >> CS2_pos) & 1) {
+			chip_Write(&chips[1], dataMode, value);
+		}
+	}
+	lastOdr = odr;
+}
+
+/**
+ * store a word to GPIOC->BSRR and sample PORTC
+ */
+void sim_Bus_Store(uint32_t word) {
+	sim_Gpioc.BSRR = word;
+	sample_Port();
+}
+
+/**
+ * capture the packets of the uart mirror into a file, return 0 on success
+ */
+int sim_Mirror_Capture(const char *fileName) {
+	sim_Mirror_Close();
+	mirrorFile = fopen(fileName, "wb");
+	return mirrorFile == NULL;
+}
+
+/**
+ * stop the capture and close the file
+ */
+void sim_Mirror_Close() {
+	if (mirrorFile != NULL) {
+		fclose(mirrorFile);
+		mirrorFile = NULL;
+	}
+}
+
+/**
+ * capture a packet of the uart mirror and count its bytes
+ */
+void sim_Mirror_Send(const uint8_t *packet, int len) {
+	counters.mirrorBytes += len;
+	if (mirrorFile != NULL) {
+		fwrite(packet, 1, len, mirrorFile);
+	}
+}
+
+/**
+ * set the TIM10 counter
+ */
+void sim_Tim_Set_Counter(uint32_t value) {
+	sample_Port();
+	timCounter = value;
+}
+
+/**
+ * read the TIM10 counter, samples PORTC and advances time by 1 micro second
+ */
+uint32_t sim_Tim_Get_Counter() {
+	sample_Port();
+	timCounter++;
+	counters.busTimeUs++;
+	sim_Dwt.CYCCNT += SystemCoreClock / 1000000;
+	return timCounter;
+}
+
+/**
+ * pixel byte the simulated lcd shows at page and column,
+ * the display start line of the controllers is applied
+ */
+uint8_t sim_Screen_Byte(int page, int col) {
+	struct ks0108 *chip = &chips[col / MAX_COLS_LCD];
+	uint8_t value = 0;
+	if (!chip->on) {
+		return 0;
+	}
+	for (int bit = 0; bit < PAGE_LEN; bit++) {
+		int ramRow = (page * PAGE_LEN + bit + chip->startLine) % TOTAL_ROWS;
+		uint8_t ramByte = chip->ram[ramRow / PAGE_LEN][col % MAX_COLS_LCD];
+		if (ramByte & (1 << (ramRow % PAGE_LEN))) {
+			value |= 1 << bit;
+		}
+	}
+	return value;
+}
+
+/**
+ * write the visible screen as binary PBM image, return 0 on success
+ */
+int sim_Write_Pbm(const char *fileName) {
+	FILE *file = fopen(fileName, "wb");
+	if (file == NULL) {
+		return 1;
+	}
+	fprintf(file, "P4\n%d %d\n", TOTAL_COLS, TOTAL_ROWS);
+	for (int row = 0; row < TOTAL_ROWS; row++) {
+		for (int col = 0; col < TOTAL_COLS; col += 8) {
+			uint8_t packed = 0;
+			for (int bit = 0; bit < 8; bit++) {
+				uint8_t pageByte = sim_Screen_Byte(row / PAGE_LEN, col + bit);
+				if (pageByte & (1 << (row % PAGE_LEN))) {
+					packed |= 0x80 >> bit;
+				}
+			}
+			fputc(packed, file);
+		}
+	}
+	fclose(file);
+	return 0;
+}
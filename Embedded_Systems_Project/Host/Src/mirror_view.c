@@ -0,0 +1,193 @@
+/**
+ * Viewer of the uart mirror.
+ * Reads the packets sent by the mirror module (Core/Src/mirror.c) from a
+ * capture file or directly from the serial port, rebuilds the frames
+ * and writes every frame as binary PBM image <prefix>NNNN.pbm,
+ * the last one also as <prefix>last.pbm. The numbered images can be
+ * put together to an animation, e.g. with ffmpeg -i mirror_%04d.pbm.
+ * The frames are sent without the scroll, the scroll of the header
+ * is applied when an image is written.
+ * Packets with a wrong checksum are dropped, after a lost packet the
+ * frames are rebuilt again from the next key frame.
+ *
+ *   stty -F /dev/ttyACM0 115200 raw
+ *   ./mirror_view /dev/ttyACM0 frame_
+ *
+ * Author Husnain Khan
+ */
+
+#include <stdio.h>
+#include "main.h"
+#include "Dem128064B.h"
+#include "mirror.h"
+
+/**
+ * longest file name of an image
+ */
+#define NAME_LEN 256
+
+/**
+ * decode the runs of a payload into frame, return 0 on success
+ */
+static int decode_Payload(const uint8_t *payload, int len, uint8_t *frame) {
+	int pos = 0;
+	int i = 0;
+	while (i < len) {
+		uint8_t control = payload[i++];
+		int run = (control & 0x7F) + 1;
+		if (pos + run > MIRROR_FRAME_LEN) {
+			return 1;
+		}
+		if (control & 0x80) {
+			if (i + run > len) {
+				return 1;
+			}
+			for (int j = 0; j < run; j++) {
+				frame[pos++] ^= payload[i++];
+			}
+		} else {
+			pos += run;
+		}
+	}
+	return 0;
+}
+
+/**
+ * write a page major frame as binary PBM image, screen row r shows
+ * row (r + scroll) % TOTAL_ROWS of the frame, return 0 on success
+ */
+static int write_Pbm(const char *fileName, const uint8_t *frame, int scroll) {
+	FILE *file = fopen(fileName, "wb");
+	if (file == NULL) {
+		return 1;
+	}
+	fprintf(file, "P4\n%d %d\n", TOTAL_COLS, TOTAL_ROWS);
+	for (int screenRow = 0; screenRow < TOTAL_ROWS; screenRow++) {
+		int row = (screenRow + scroll) % TOTAL_ROWS;
+		for (int col = 0; col < TOTAL_COLS; col += 8) {
+			uint8_t packed = 0;
+			for (int bit = 0; bit < 8; bit++) {
+				uint8_t pageByte = frame[(row / PAGE_LEN) * TOTAL_COLS + col + bit];
+				if (pageByte & (1 << (row % PAGE_LEN))) {
+					packed |= 0x80 >> bit;
+				}
+			}
+			fputc(packed, file);
+		}
+	}
+	fclose(file);
+	return 0;
+}
+
+/**
+ * read the next packet, sync bytes are searched first,
+ * return the length of its payload or -1 at the end of the input
+ */
+static int read_Packet(FILE *in, uint8_t *header, uint8_t *payload,
+		uint32_t *dropped) {
+	int last = -1;
+	int c;
+	while ((c = fgetc(in)) != EOF) {
+		if (last == MIRROR_SYNC1 && c == MIRROR_SYNC2) {
+			if (fread(header + 2, 1, MIRROR_HEADER_LEN - 2, in)
+					!= MIRROR_HEADER_LEN - 2) {
+				return -1;
+			}
+			int len = header[5] | (header[6] << 8);
+			if (len > MIRROR_PAYLOAD_MAX) {
+				(*dropped)++;
+				last = -1;
+				continue;
+			}
+			int checksum = 0;
+			if (fread(payload, 1, len, in) != (size_t) len
+					|| (checksum = fgetc(in)) == EOF) {
+				return -1;
+			}
+			uint8_t sum = 0;
+			for (int i = 2; i < MIRROR_HEADER_LEN; i++) {
+				sum ^= header[i];
+			}
+			for (int i = 0; i < len; i++) {
+				sum ^= payload[i];
+			}
+			if (sum != checksum) {
+				(*dropped)++;
+				last = -1;
+				continue;
+			}
+			return len;
+		}
+		last = c;
+	}
+	return -1;
+}
+
+int main(int argc, char **argv) {
+	static uint8_t frame[MIRROR_FRAME_LEN];
+	static uint8_t payload[MIRROR_PAYLOAD_MAX];
+	uint8_t header[MIRROR_HEADER_LEN] = { MIRROR_SYNC1, MIRROR_SYNC2 };
+	char fileName[NAME_LEN];
+	uint32_t frames = 0;
+	uint32_t keyFrames = 0;
+	uint32_t dropped = 0;
+	uint32_t lost = 0;
+	uint64_t bytes = 0;
+	int synced = 0;
+	int nextSeq = 0;
+	int scroll = 0;
+	int len;
+
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <capture> [prefix]\n", argv[0]);
+		return 2;
+	}
+	const char *prefix = argc > 2 ? argv[2] : "mirror_";
+	FILE *in = fopen(argv[1], "rb");
+	if (in == NULL) {
+		perror(argv[1]);
+		return 2;
+	}
+
+	while ((len = read_Packet(in, header, payload, &dropped)) >= 0) {
+		bytes += MIRROR_HEADER_LEN + len + MIRROR_TRAILER_LEN;
+		int seq = header[2];
+		scroll = header[4] % TOTAL_ROWS;
+		if (header[3] & MIRROR_FLAG_KEY) {
+			for (int i = 0; i < MIRROR_FRAME_LEN; i++) {
+				frame[i] = 0;
+			}
+			synced = 1;
+			keyFrames++;
+		} else if (synced && seq != nextSeq) {
+			// a packet is missing, wait for the next key frame
+			synced = 0;
+			lost++;
+		}
+		nextSeq = (seq + 1) & 0xFF;
+		if (!synced) {
+			continue;
+		}
+		if (decode_Payload(payload, len, frame) != 0) {
+			synced = 0;
+			dropped++;
+			continue;
+		}
+		snprintf(fileName, sizeof(fileName), "%s%04u.pbm", prefix, frames);
+		if (write_Pbm(fileName, frame, scroll) != 0) {
+			perror(fileName);
+			return 2;
+		}
+		frames++;
+	}
+	fclose(in);
+
+	if (frames > 0) {
+		snprintf(fileName, sizeof(fileName), "%slast.pbm", prefix);
+		write_Pbm(fileName, frame, scroll);
+	}
+	printf("%u frames, %u key frames, %llu bytes, %u bad packets, "
+			"%u lost packets\n", frames, keyFrames, (unsigned long long) bytes,
+			dropped, lost);
+	return frames == 0 || dropped != 0;
+}
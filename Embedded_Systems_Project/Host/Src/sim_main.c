@@ -0,0 +1,519 @@
+/**
+ * Host run of the LCD driver against the KS0108 bus simulator.
+ * Plays the screens of the game (welcome, moving lines and ball, game over)
+ * and a text overlay, sends frames in time slices like the SysTick handler,
+ * checks after every refresh that the simulated lcd shows the presented frame,
+ * reports the bus cost of every refreshScreen call and the measurements
+ * of the display entry points and writes PBM images of the key frames.
+ * The scroll scene moves a playfield with the display start line and
+ * draws only the rows which become visible.
+ * The gray game scene steps the gray phases while the frames are sent
+ * in slices and checks that every phase is on the lcd before the next one.
+ * Every presented frame is sent by the uart mirror, the packets are
+ * captured into mirror.bin and their size is checked against the uart
+ * bandwidth.
+ *
+ * Author Husnain Khan
+ */
+
+#include <stdio.h>
+#include "main.h"
+#include "ks0108_sim.h"
+#include "Dem128064B.h"
+#include "perf.h"
+#include "mirror.h"
+#include "app_config.h"
+
+/**
+ * frames of the game scene
+ */
+#define GAME_FRAMES 60
+
+/**
+ * the moving lines of the game, same as in app.c
+ */
+static const uint8_t upperLineData[] = { 0xFF, 0xFF, 0xFF, 0x3F };
+static const struct bitmap upperLineSprite = { 1, LENGTH_UPPER_LINE,
+		upperLineData };
+static const uint8_t lowerLineData[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+static const struct bitmap lowerLineSprite = { 1, LENGTH_OF_LOWER_LINE,
+		lowerLineData };
+
+/**
+ * score shown on the game over screen, left column of the two digits
+ */
+#define GAME_OVER_SCORE 42
+#define GAME_OVER_SCORE_COL 40
+
+/**
+ * frames of the scroll scene in each direction and the playfield row
+ * shown at the top when it starts
+ */
+#define SCROLL_FRAMES 48
+#define SCROLL_TOP_ROW 1000
+
+/**
+ * ticks of the gray game scene, the phase rate, the dimmed band and the
+ * ball trail are the ones of the firmware (app_config.h).
+ * Every frame must be sent within REFRESH_RATE slices
+ */
+#define GRAY_TICKS 3000
+
+/**
+ * bus cost of the gray phases
+ */
+struct gray_cost {
+	uint32_t phases;
+	uint32_t late;
+	uint32_t strobes;
+	uint32_t maxStrobes;
+	uint32_t maxTicks;
+};
+
+/**
+ * bytes the uart mirror can send per frame, 115200 baud with 10 bits per byte
+ */
+#define MIRROR_BYTES_PER_FRAME (115200 / 10 * REFRESH_RATE / 1000)
+
+/**
+ * accumulated bus cost of the refresh calls of one scene
+ */
+struct scene_cost {
+	uint32_t refreshes;
+	uint32_t strobes;
+	uint32_t busTimeUs;
+	uint32_t maxStrobes;
+	uint32_t maxTimeUs;
+	uint32_t mismatches;
+	uint32_t mirrorFrames;
+	uint32_t mirrorBytes;
+	uint32_t maxMirrorBytes;
+};
+
+/**
+ * number of bytes in which the simulated lcd differs from the presented frame
+ */
+static uint32_t compare_Screen() {
+	uint32_t mismatches = 0;
+	for (int page = 0; page < TOTAL_PAGES; page++) {
+		for (int col = 0; col < TOTAL_COLS; col++) {
+			if (sim_Screen_Byte(page, col) != get_Screen_Byte(page, col)) {
+				mismatches++;
+			}
+		}
+	}
+	return mismatches;
+}
+
+/**
+ * present a frame and send it by the uart mirror, add the packet to the scene
+ */
+static void present_Frame(struct scene_cost *cost) {
+	uint32_t before = sim_Get_Counters().mirrorBytes;
+	present();
+	mirror_Frame();
+	uint32_t bytes = sim_Get_Counters().mirrorBytes - before;
+	cost->mirrorFrames++;
+	cost->mirrorBytes += bytes;
+	if (bytes > cost->maxMirrorBytes) {
+		cost->maxMirrorBytes = bytes;
+	}
+}
+
+/**
+ * present and refresh one frame, add its bus cost to the scene
+ */
+static void refresh_Frame(struct scene_cost *cost) {
+	present_Frame(cost);
+	struct sim_counters before = sim_Get_Counters();
+	refreshScreen();
+	struct sim_counters after = sim_Get_Counters();
+
+	uint32_t strobes = after.strobes - before.strobes;
+	cost->refreshes++;
+	cost->strobes += strobes;
+	cost->busTimeUs += after.busTimeUs - before.busTimeUs;
+	if (strobes > cost->maxStrobes) {
+		cost->maxStrobes = strobes;
+	}
+	// time measured by the driver itself, must match the modeled bus time
+	if (get_Last_Refresh_Time_Us() > cost->maxTimeUs) {
+		cost->maxTimeUs = get_Last_Refresh_Time_Us();
+	}
+	cost->mismatches += compare_Screen();
+}
+
+/**
+ * present one frame and send it in slices like the SysTick handler does,
+ * every slice is counted as one refresh of the scene,
+ * return the number of slices needed
+ */
+static uint32_t refresh_Sliced(struct scene_cost *cost) {
+	uint32_t slices = 0;
+	int done = 0;
+	present_Frame(cost);
+	while (!done && slices < REFRESH_RATE) {
+		struct sim_counters before = sim_Get_Counters();
+		done = refresh_Screen_Slice();
+		struct sim_counters after = sim_Get_Counters();
+
+		uint32_t strobes = after.strobes - before.strobes;
+		uint32_t timeUs = after.busTimeUs - before.busTimeUs;
+		cost->refreshes++;
+		cost->strobes += strobes;
+		cost->busTimeUs += timeUs;
+		if (strobes > cost->maxStrobes) {
+			cost->maxStrobes = strobes;
+		}
+		if (timeUs > cost->maxTimeUs) {
+			cost->maxTimeUs = timeUs;
+		}
+		slices++;
+	}
+	cost->mismatches += compare_Screen();
+	return slices;
+}
+
+#if LCD_GRAYSCALE
+/**
+ * The game with gray pixels like app.c: a dimmed band between the lanes and
+ * a fading trail behind the ball. Every tick sends one slice, every
+ * GRAY_PHASE_RATE ticks the phase steps and every REFRESH_RATE ticks a frame
+ * is presented. A phase must be on the lcd before the next one starts.
+ * Return 0 when the image of the last phase is written
+ */
+static int gray_Scene(struct scene_cost *cost, struct gray_cost *gray,
+		int ball, int upperLine, int lowerLine) {
+	int trailCol[GRAY_TRAIL_LEN];
+	int trailRow[GRAY_TRAIL_LEN];
+	int trailLen = 0;
+	int ballCol = 10;
+	int ballRow = 40;
+	int lineCol = 127;
+	int phaseStart = 0;
+	int phaseDone = 1;
+	uint32_t phaseStrobes = 0;
+
+	gray_Fill_Rect(0, GRAY_LANE_ROW, TOTAL_COLS, GRAY_LANE_HEIGHT,
+			GRAY_LANE_LEVEL);
+	scene_Show(ball, 1);
+	scene_Show(upperLine, 1);
+	scene_Show(lowerLine, 1);
+	for (int tick = 0; tick < GRAY_TICKS; tick++) {
+		if (tick % REFRESH_RATE == 0) {
+			for (int i = 0; i < trailLen; i++) {
+				gray_Blit(&ballSprite, trailCol[i], trailRow[i], 0);
+			}
+			for (int i = GRAY_TRAIL_LEN - 1; i > 0; i--) {
+				trailCol[i] = trailCol[i - 1];
+				trailRow[i] = trailRow[i - 1];
+			}
+			trailCol[0] = ballCol;
+			trailRow[0] = ballRow;
+			trailLen = trailLen < GRAY_TRAIL_LEN ? trailLen + 1 : trailLen;
+			for (int i = trailLen - 1; i >= 0; i--) {
+				gray_Blit(&ballSprite, trailCol[i], trailRow[i],
+						GRAY_TRAIL_LEN - i);
+			}
+			ballCol = (ballCol + 3) % TOTAL_COLS;
+			ballRow = 36 + (tick / REFRESH_RATE) % 20;
+			lineCol = lineCol < 0 ? 127 : lineCol - 2;
+			scene_Move(ball, ballCol, ballRow);
+			scene_Move(upperLine, lineCol, 0);
+			scene_Move(lowerLine, lineCol / 2, 30);
+			scene_Update();
+			present_Frame(cost);
+		}
+		if (tick % GRAY_PHASE_RATE == 0) {
+			if (!phaseDone) {
+				gray->late++;
+			}
+			gray_Next_Phase();
+			phaseStart = tick;
+			phaseDone = 0;
+			phaseStrobes = 0;
+			gray->phases++;
+		}
+
+		struct sim_counters before = sim_Get_Counters();
+		int done = refresh_Screen_Slice();
+		struct sim_counters after = sim_Get_Counters();
+		uint32_t strobes = after.strobes - before.strobes;
+		phaseStrobes += strobes;
+		gray->strobes += strobes;
+		cost->refreshes++;
+		cost->strobes += strobes;
+		cost->busTimeUs += after.busTimeUs - before.busTimeUs;
+		if (strobes > cost->maxStrobes) {
+			cost->maxStrobes = strobes;
+		}
+		if (after.busTimeUs - before.busTimeUs > cost->maxTimeUs) {
+			cost->maxTimeUs = after.busTimeUs - before.busTimeUs;
+		}
+		if (done && !phaseDone) {
+			phaseDone = 1;
+			cost->mismatches += compare_Screen();
+			if (tick - phaseStart + 1 > gray->maxTicks) {
+				gray->maxTicks = tick - phaseStart + 1;
+			}
+			if (phaseStrobes > gray->maxStrobes) {
+				gray->maxStrobes = phaseStrobes;
+			}
+		}
+	}
+	int failed = sim_Write_Pbm("gray.pbm");
+
+	gray_Fill_Rect(0, 0, TOTAL_COLS, TOTAL_ROWS, 0);
+	scene_Show(ball, 0);
+	scene_Show(upperLine, 0);
+	scene_Show(lowerLine, 0);
+	scene_Update();
+	return failed;
+}
+#endif
+
+/**
+ * Draw one row of the scrolling playfield into a row of the display array,
+ * walls at both sides and every 8th row a bar with a gap
+ */
+static void draw_Playfield_Row(int playfieldRow, int arrayRow) {
+	fill_Rect(0, arrayRow, 2, 1, ROP_OR);
+	fill_Rect(TOTAL_COLS - 2, arrayRow, 2, 1, ROP_OR);
+	if (playfieldRow % 8 == 0) {
+		int gap = 2 + (playfieldRow * 37) % (TOTAL_COLS - 28);
+		fill_Rect(2, arrayRow, TOTAL_COLS - 4, 1, ROP_OR);
+		fill_Rect(gap, arrayRow, 24, 1, ROP_AND_NOT);
+	}
+}
+
+/**
+ * Scroll a playfield up by 1 to 3 rows per frame, refreshed at once,
+ * and back down again one row per frame, refreshed in slices.
+ * Only the rows which become visible are drawn
+ */
+static void scroll_Scene(struct scene_cost *cost,
+		struct scene_cost *slicedCost) {
+	struct scene_cost fillCost = { 0 };
+	int topRow = SCROLL_TOP_ROW;
+
+	init_DisplayArray();
+	for (int row = 0; row < TOTAL_ROWS; row++) {
+		draw_Playfield_Row(topRow + row, scroll_Row(row));
+	}
+	refresh_Frame(&fillCost);
+	cost->mismatches += fillCost.mismatches;
+
+	for (int frame = 0; frame < SCROLL_FRAMES; frame++) {
+		int lines = 1 + frame % 3;
+		scroll_Lines(lines);
+		topRow += lines;
+		for (int row = TOTAL_ROWS - lines; row < TOTAL_ROWS; row++) {
+			draw_Playfield_Row(topRow + row, scroll_Row(row));
+		}
+		refresh_Frame(cost);
+	}
+	for (int frame = 0; frame < SCROLL_FRAMES; frame++) {
+		int first = scroll_Lines(-1);
+		topRow--;
+		draw_Playfield_Row(topRow, first);
+		refresh_Sliced(slicedCost);
+	}
+}
+
+/**
+ * print the mirror bytes of one scene
+ */
+static void print_Mirror(const char *scene, const struct scene_cost *cost) {
+	uint32_t frames = cost->mirrorFrames > 0 ? cost->mirrorFrames : 1;
+	printf("%-12s %6u %12u %12u\n", scene, cost->mirrorFrames,
+			cost->mirrorBytes / frames, cost->maxMirrorBytes);
+}
+
+/**
+ * print the cost of one scene
+ */
+static void print_Cost(const char *scene, const struct scene_cost *cost) {
+	uint32_t refreshes = cost->refreshes > 0 ? cost->refreshes : 1;
+	printf("%-12s %6u %12u %12u %12u %12u %10u\n", scene, cost->refreshes,
+			cost->strobes / refreshes, cost->maxStrobes,
+			cost->busTimeUs / refreshes, cost->maxTimeUs, cost->mismatches);
+}
+
+int main(void) {
+	struct scene_cost setUpCost = { 0 };
+	struct scene_cost welcomeCost = { 0 };
+	struct scene_cost gameCost = { 0 };
+	struct scene_cost gameOverCost = { 0 };
+	struct scene_cost textCost = { 0 };
+	struct scene_cost slicedCost = { 0 };
+	struct scene_cost grayCost = { 0 };
+	struct scene_cost scrollCost = { 0 };
+	struct scene_cost scrollBackCost = { 0 };
+	struct gray_cost grayPhases = { 0 };
+	int failed = 0;
+
+	sim_Reset();
+	setUp();
+	struct sim_counters afterSetUp = sim_Get_Counters();
+	setUpCost.refreshes = 1;
+	setUpCost.strobes = afterSetUp.strobes;
+	setUpCost.maxStrobes = afterSetUp.strobes;
+	setUpCost.busTimeUs = afterSetUp.busTimeUs;
+	setUpCost.maxTimeUs = afterSetUp.busTimeUs;
+	failed |= sim_Mirror_Capture("mirror.bin");
+	mirror_Enable(1);
+
+	// welcome message, banners are drawn into the static layer
+	select_Layer(LAYER_STATIC);
+	writeWelcomeToArray();
+	refresh_Frame(&welcomeCost);
+	failed |= sim_Write_Pbm("welcome.pbm");
+	init_DisplayArray();
+	refresh_Frame(&welcomeCost);
+
+	// game, two lines moving from the right side and a moving ball
+	// over a static label, which is never sent again
+	drawText("LEVEL 1", 84, 2, &smallFont);
+	select_Layer(LAYER_DYNAMIC);
+	// the objects are moved like in app.c and drawn by scene_Update
+	int lineCol = 127;
+	int lineColSlowMove = 127;
+	int ball = scene_Add(&ballSprite, 49, 49);
+	int upperLine = scene_Add(&upperLineSprite, lineCol, 0);
+	int lowerLine = scene_Add(&lowerLineSprite, lineColSlowMove, 30);
+	for (int frame = 0; frame < GAME_FRAMES; frame++) {
+		scene_Move(upperLine, lineCol, 0);
+		lineCol = lineCol < 0 ? 127 : lineCol - 1;
+		if (frame % 2 == 0) {
+			scene_Move(lowerLine, lineColSlowMove, 30);
+			lineColSlowMove = lineColSlowMove < 0 ? 127 : lineColSlowMove - 1;
+		}
+		scene_Move(ball, 49 + frame / 3, 39 + frame % 10);
+		scene_Update();
+		refresh_Frame(&gameCost);
+	}
+	failed |= sim_Write_Pbm("game.pbm");
+
+	// game over message with score in the order of app_loop: the objects
+	// are hidden by a refresh, then the periodic refresh is paused and the
+	// banner is drawn into the static layer and sent by refreshNow
+	scene_Show(ball, 0);
+	scene_Show(upperLine, 0);
+	scene_Show(lowerLine, 0);
+	scene_Update();
+	refresh_Frame(&gameOverCost);
+	select_Layer(LAYER_STATIC);
+	writeGameOver();
+	drawNumber(GAME_OVER_SCORE, 2, GAME_OVER_SCORE_COL, SCORE_ROW, &scoreFont);
+	refresh_Frame(&gameOverCost);
+	failed |= sim_Write_Pbm("gameover.pbm");
+	init_DisplayArray();
+	select_Layer(LAYER_DYNAMIC);
+
+	// text overlay, small font and a counter with more digits than the score
+	init_DisplayArray();
+	drawText("HUD: SCORE", 0, 0, &smallFont);
+	drawNumber(1234567, 1, 0, 9, &smallFont);
+	drawText("the quick brown fox", 0, 56, &smallFont);
+	refresh_Frame(&textCost);
+	for (uint32_t counter = 0; counter < GAME_FRAMES; counter++) {
+		drawNumber(counter * 7, 4, 70, 9, &smallFont);
+		refresh_Frame(&textCost);
+	}
+	failed |= sim_Write_Pbm("text.pbm");
+
+#if LCD_GRAYSCALE
+	// the game with a dimmed band and a ball trail, sent in slices
+	init_DisplayArray();
+	failed |= gray_Scene(&grayCost, &grayPhases, ball, upperLine, lowerLine);
+#endif
+
+	// scrolling playfield, back at scroll 0 when done
+	scroll_Scene(&scrollCost, &scrollBackCost);
+	failed |= sim_Write_Pbm("scroll.pbm");
+	init_DisplayArray();
+	set_Scroll(0);
+
+	// sliced refresh, a full screen change and the moving line again
+	uint32_t maxSlices = refresh_Sliced(&slicedCost);
+	invert_DisplayArr();
+	uint32_t slices = refresh_Sliced(&slicedCost);
+	maxSlices = slices > maxSlices ? slices : maxSlices;
+	init_DisplayArray();
+	scene_Show(upperLine, 1);
+	for (int frame = 0; frame < GAME_FRAMES; frame++) {
+		scene_Move(upperLine, lineCol, 0);
+		lineCol = lineCol < 0 ? 127 : lineCol - 1;
+		scene_Update();
+		slices = refresh_Sliced(&slicedCost);
+		maxSlices = slices > maxSlices ? slices : maxSlices;
+	}
+	failed |= sim_Write_Pbm("sliced.pbm");
+	sim_Mirror_Close();
+
+	printf("%-12s %6s %12s %12s %12s %12s %10s\n", "scene", "frames",
+			"avg strobes", "max strobes", "avg bus us", "max us",
+			"mismatch");
+	print_Cost("setUp", &setUpCost);
+	print_Cost("welcome", &welcomeCost);
+	print_Cost("game", &gameCost);
+	print_Cost("game over", &gameOverCost);
+	print_Cost("text", &textCost);
+	print_Cost("sliced", &slicedCost);
+#if LCD_GRAYSCALE
+	print_Cost("gray", &grayCost);
+#endif
+	print_Cost("scroll", &scrollCost);
+	print_Cost("scroll back", &scrollBackCost);
+	printf("sliced refresh: at most %u slices per frame, %u us measured "
+			"by the driver\n", maxSlices, get_Max_Slice_Time_Us());
+
+	printf("\n%-12s %6s %12s %12s   budget %d bytes per frame\n", "mirror",
+			"frames", "avg bytes", "max bytes", MIRROR_BYTES_PER_FRAME);
+	print_Mirror("welcome", &welcomeCost);
+	print_Mirror("game", &gameCost);
+	print_Mirror("game over", &gameOverCost);
+	print_Mirror("text", &textCost);
+	print_Mirror("sliced", &slicedCost);
+	print_Mirror("scroll", &scrollCost);
+#if LCD_GRAYSCALE
+	print_Mirror("gray", &grayCost);
+	printf("\ngray phases: %u, sent within %u of %d ticks, %u strobes per "
+			"phase (max %u), %u late\n", grayPhases.phases,
+			grayPhases.maxTicks, GRAY_PHASE_RATE,
+			grayPhases.strobes / grayPhases.phases, grayPhases.maxStrobes,
+			grayPhases.late);
+#endif
+	printf("\n");
+
+	// measurements of the display entry points, times of the host cpu,
+	// there is no sensor in the simulation
+	char line[PERF_LINE_LEN];
+	for (int i = -1; i < PERF_MPU_INIT; i++) {
+		perf_Format(i, line, sizeof(line));
+		fputs(line, stdout);
+	}
+
+	uint32_t mismatches = welcomeCost.mismatches + gameCost.mismatches
+			+ gameOverCost.mismatches + textCost.mismatches
+			+ slicedCost.mismatches + grayCost.mismatches
+			+ scrollCost.mismatches + scrollBackCost.mismatches;
+	if (mismatches != 0) {
+		printf("simulated lcd differs from the presented frame\n");
+		failed = 1;
+	}
+	if (gameCost.mirrorBytes / gameCost.mirrorFrames > MIRROR_BYTES_PER_FRAME) {
+		printf("uart mirror of the game does not fit the uart bandwidth\n");
+		failed = 1;
+	}
+	if (grayPhases.late != 0) {
+		printf("gray phases are not sent within %d ticks\n", GRAY_PHASE_RATE);
+		failed = 1;
+	}
+	if (maxSlices >= REFRESH_RATE) {
+		printf("sliced refresh does not finish a frame within %d ticks\n",
+				REFRESH_RATE);
+		failed = 1;
+	}
+	return failed;
+}